@@ -0,0 +1,102 @@
+#pragma once
+
+#include "function.hpp"
+#include "instruction.hpp"
+#include <iostream>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sc {
+
+enum class AliasResult { NO_ALIAS, MAY_ALIAS, MUST_ALIAS };
+
+/*
+ * Address held by a pointer: a root pointer plus an offset in elements,
+ * std::nullopt when it's not a constant. Ids and ptradds are looked
+ * through, anything else is its own root.
+ */
+struct MemoryLocation {
+    OperandBase *root = nullptr;
+    std::optional<int64_t> offset = 0;
+};
+
+/*
+ * Allocation-site based points-to and alias analysis of a function in SSA
+ * form, see Cooper and Torczon Ch 9.4.4. The origins of a pointer are the
+ * instructions its value may come from through ids, ptradds and gets:
+ *
+ *   - alloc, a fresh object of this function. Two allocs never return the
+ *     same object.
+ *   - getarg, an object that existed when the function was entered, so
+ *     never one allocated by the function.
+ *   - load and call, any object but the allocations of the function that
+ *     don't escape. An allocation escapes when a pointer to it is stored
+ *     or passed to a call, the caller may also read the ones returned.
+ *
+ * Pointers with the same root compare their offsets. The answer is about
+ * the values both pointers hold at a point where both are defined, which
+ * SSA guarantees were computed from the same value of the root. Only the
+ * instructions are looked at, so like InductionAnalyzer it isn't cached
+ * on the function.
+ */
+class AliasAnalyzer {
+  public:
+    AliasAnalyzer(Function *f) : func(f) {}
+
+    void Analyze();
+
+    AliasResult Alias(OperandBase *p, OperandBase *q) const;
+
+    bool MayAlias(OperandBase *p, OperandBase *q) const {
+        return Alias(p, q) != AliasResult::NO_ALIAS;
+    }
+
+    bool MustAlias(OperandBase *p, OperandBase *q) const {
+        return Alias(p, q) == AliasResult::MUST_ALIAS;
+    }
+
+    // Whether instr may change the value loaded from p: a store through a
+    // pointer that may alias p, a free or a call that may write or free
+    // the object p points to
+    bool MayModify(InstructionBase *instr, OperandBase *p) const;
+
+    // Whether instr may read the value stored through p: a load through a
+    // pointer that may alias p, a call that may read the object p points
+    // to or a ret after which the caller may
+    bool MayRead(InstructionBase *instr, OperandBase *p) const;
+
+    // Whether p and q may point into the same object whatever their
+    // offsets, which also holds for values of different loop iterations
+    bool MayShareObject(OperandBase *p, OperandBase *q) const;
+
+    static MemoryLocation GetLocation(OperandBase *p);
+
+    // Empty for pointers that are never defined
+    const std::set<InstructionBase *> &GetOrigins(OperandBase *p) const;
+
+    bool IsEscaped(InstructionBase *alloc) const {
+        return escaped.contains(alloc);
+    }
+
+    bool IsReturned(InstructionBase *alloc) const {
+        return returned.contains(alloc);
+    }
+
+    void DumpOrigins(std::ostream &out = std::cout) const;
+
+  private:
+    Function *func;
+    std::unordered_map<OperandBase *, std::set<InstructionBase *>> origins;
+    std::unordered_set<InstructionBase *> escaped;
+    std::unordered_set<InstructionBase *> returned;
+
+    void FindOrigins();
+    void FindEscaped();
+
+    bool MayBeSameObject(InstructionBase *a, InstructionBase *b) const;
+    // Whether code outside the function may reach the object p points to
+    bool MayBeVisible(OperandBase *p) const;
+};
+} // namespace sc
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "function.hpp"
+#include "instruction.hpp"
+#include "program.hpp"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Call graph of a program. A call is resolved to the function of the
+ * program with the name it calls. The strongly connected components are
+ * the sets of mutually recursive functions, they are kept in bottom-up
+ * order, every component comes after the components it calls.
+ */
+class CallGraphAnalyzer {
+  public:
+    CallGraphAnalyzer(Program *p) : program(p) {}
+
+    void Analyze();
+
+    // nullptr if the program doesn't define name
+    Function *GetFunction(const std::string &name) const {
+        auto it = functions.find(name);
+        return it == functions.end() ? nullptr : it->second;
+    }
+
+    // In the order of the calls in the function, without repetitions
+    const std::vector<Function *> &GetCallees(Function *func) const {
+        return callees.at(func);
+    }
+
+    const std::vector<CallInstruction *> &GetCalls(Function *func) const {
+        return calls.at(func);
+    }
+
+    // Callees come before their callers
+    const std::vector<std::vector<Function *>> &GetSCCs() const {
+        return sccs;
+    }
+
+    size_t GetSCCIndex(Function *func) const { return scc_index.at(func); }
+
+    // Calls itself, directly or through other functions
+    bool IsRecursive(Function *func) const;
+
+    // Callees before callers, and callers before callees
+    std::vector<Function *> GetBottomUpOrder() const;
+    std::vector<Function *> GetTopDownOrder() const;
+
+    void DumpCallGraph(std::ostream &out = std::cout) const;
+
+  private:
+    Program *program;
+    std::unordered_map<std::string, Function *> functions;
+    std::unordered_map<Function *, std::vector<Function *>> callees;
+    std::unordered_map<Function *, std::vector<CallInstruction *>> calls;
+    std::vector<std::vector<Function *>> sccs;
+    std::unordered_map<Function *, size_t> scc_index;
+
+    void FindSCCs();
+};
+} // namespace sc
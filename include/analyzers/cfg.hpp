@@ -46,7 +46,7 @@ class ForwardCFG : public CFGContainer {
 
 class ReverseCFG : public CFGContainer {
   public:
-    ReverseCFG(Function *func) : CFGContainer(LAST_BLK(func)) {}
+    ReverseCFG(Function *func) : CFGContainer(GetExit(func)) {}
 
     bool HasSuccessors(Block *blk) override {
         return blk->GetPredecessorSize();
@@ -63,6 +63,20 @@ class ReverseCFG : public CFGContainer {
     std::span<Block *> GetPredecessors(Block *blk) override {
         return blk->GetSuccessors();
     }
+
+  private:
+    // The unique block that returns. It starts out last but merging blocks
+    // into their predecessors, e.g. after TRE, may leave it anywhere.
+    static Block *GetExit(Function *func) {
+        for (auto i = func->GetBlockSize(); i-- > 0;) {
+            auto *block = func->GetBlock(i);
+            if (block->GetInstructionSize() &&
+                LAST_INSTR(block)->GetOpcode() == Opcode::RET) {
+                return block;
+            }
+        }
+        return LAST_BLK(func);
+    }
 };
 
 using CFG = CFGContainer;
@@ -70,4 +84,5 @@ using CFG = CFGContainer;
 const std::vector<Block *> GetPostOrder(CFG *cfg);
 const std::vector<Block *> GetReversePostOrder(CFG *cfg);
 std::unique_ptr<Program> BuildCFG(std::unique_ptr<Program> program);
+void BuildCFG(Function *func);
 }; // namespace sc
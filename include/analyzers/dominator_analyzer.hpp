@@ -18,6 +18,9 @@ class DominatorAnalyzer {
         }
     }
 
+    // Entry point used when the analysis is cached on the function
+    void Analyze() { BuildDominatorTree(); }
+
     void ComputeDominance();
     void ComputeImmediateDominators();
     void ComputeDominanceFrontier();
@@ -33,7 +36,12 @@ class DominatorAnalyzer {
         return dom[idx];
     }
 
-    Block *GetImmediateDominator(size_t idx) {
+    // Does a dominate b
+    bool Dominates(Block *a, Block *b) const {
+        return dom.at(b->GetIndex()).Get(a->GetIndex());
+    }
+
+    Block *GetImmediateDominator(size_t idx) const {
         assert(idx < func->GetBlockSize());
         return idom[idx];
     }
@@ -7,6 +7,7 @@
 #include <ranges>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace sc {
 
@@ -19,12 +20,14 @@ class GlobalsAnalyzer {
     void DumpGlobals(std::ostream &out = std::cout) const;
     void DumpBlocks(std::ostream &out = std::cout) const;
 
+    // Globals and their blocks are visited in program order, so the
+    // result doesn't depend on the addresses of the operands.
     auto GetGlobals() {
-        return std::ranges::subrange(globals.begin(), globals.end());
+        return std::ranges::subrange(order.begin(), order.end());
     }
 
     auto GetBlocks(OperandBase *op) {
-        static std::unordered_set<Block *> empty;
+        static std::vector<Block *> empty;
         if (blocks.contains(op)) {
             return std::ranges::subrange(blocks[op].begin(),
                                          blocks[op].end());
@@ -36,7 +39,8 @@ class GlobalsAnalyzer {
   private:
     Function *func;
     std::unordered_set<OperandBase *> globals;
-    std::unordered_map<OperandBase *, std::unordered_set<Block *>> blocks;
+    std::vector<OperandBase *> order;
+    std::unordered_map<OperandBase *, std::vector<Block *>> blocks;
 
     void Process(std::unordered_set<OperandBase *> &var_kill,
                  InstructionBase *instr, Block *block);
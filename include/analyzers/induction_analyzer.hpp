@@ -0,0 +1,80 @@
+#pragma once
+
+#include "analyzers/loop_analyzer.hpp"
+#include "function.hpp"
+#include "instruction.hpp"
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Basic induction variable of a loop, a strongly connected region of the
+ * SSA graph that goes through a get in the loop header, see Cooper,
+ * Simpson and Vick, Operator Strength Reduction. Every member is a get,
+ * id, add, sub or ptradd and the operands from outside the region are
+ * region constants, so every value of the region is the value entering
+ * the loop plus a sum of region constants.
+ */
+struct InductionVariable {
+    Loop *loop;
+    // In function order, every member comes after the members defining
+    // its operands except for the values carried by the gets.
+    std::vector<InstructionBase *> members;
+};
+
+/*
+ * Value computed in the loop from an induction variable (basic or
+ * derived) and a region constant: iv + rc, rc + iv, iv - rc, iv * rc,
+ * rc * iv or ptradd rc iv.
+ */
+struct DerivedInductionVariable {
+    InstructionBase *instr;
+    OperandBase *iv;
+    OperandBase *rc;
+};
+
+/*
+ * Induction variables of the loops of a function in SSA form. Only the
+ * instructions are looked at, so unlike the CFG analyses it isn't cached
+ * on the function, passes that rewrite induction variables recompute it.
+ */
+class InductionAnalyzer {
+  public:
+    InductionAnalyzer(Function *f) : func(f) {}
+
+    void Analyze();
+
+    // Defined outside the loop or by a const
+    static bool IsRegionConstant(Loop *loop, OperandBase *op);
+
+    const std::vector<InductionVariable> &GetInductionVariables(Loop *loop) {
+        return ivs[loop];
+    }
+
+    // In the order they are computed
+    const std::vector<DerivedInductionVariable> &
+    GetDerivedInductionVariables(Loop *loop) {
+        return derived[loop];
+    }
+
+    // Basic induction variable of loop op belongs to, nullptr if none
+    const InductionVariable *GetInductionVariable(Loop *loop,
+                                                  OperandBase *op) const;
+
+    void DumpInductionVariables(std::ostream &out = std::cout);
+
+  private:
+    Function *func;
+    std::unordered_map<Loop *, std::vector<InductionVariable>> ivs;
+    std::unordered_map<Loop *, std::vector<DerivedInductionVariable>> derived;
+    std::unordered_map<Loop *, std::unordered_map<OperandBase *, size_t>>
+        iv_index;
+
+    void FindInductionVariables(Loop *loop);
+    void FindDerivedInductionVariables(Loop *loop);
+    bool IsInductionVariable(Loop *loop,
+                             const std::vector<InstructionBase *> &scc) const;
+};
+} // namespace sc
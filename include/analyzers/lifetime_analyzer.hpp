@@ -0,0 +1,50 @@
+#pragma once
+
+#include "analyzers/loop_analyzer.hpp"
+#include "function.hpp"
+#include "instruction.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Lifetimes of the allocations of a function in SSA form. The frees of
+ * an allocation are the frees of its pointer, through ids, so they free
+ * the object its latest execution returned. An allocation is freed in the
+ * function when every path from it to a ret frees it before allocating
+ * again, and freed in an iteration of a loop when every path from it to a
+ * latch or out of the loop frees it.
+ *
+ * Allocations freed in an iteration never have two objects live at the
+ * same time, so a loop can reuse one object, and allocations freed in the
+ * function could be served from the frame of the call. Only the
+ * instructions are looked at, so it isn't cached on the function.
+ */
+class LifetimeAnalyzer {
+  public:
+    LifetimeAnalyzer(Function *f) : func(f) {}
+
+    void Analyze();
+
+    const std::vector<InstructionBase *> &GetFrees(InstructionBase *alloc) {
+        return frees[alloc];
+    }
+
+    bool IsFreedInFunction(InstructionBase *alloc) {
+        return IsFreed(alloc, nullptr);
+    }
+
+    bool IsFreedInIteration(InstructionBase *alloc, Loop *loop) {
+        return IsFreed(alloc, loop);
+    }
+
+    void DumpLifetimes(std::ostream &out = std::cout);
+
+  private:
+    Function *func;
+    std::unordered_map<InstructionBase *, std::vector<InstructionBase *>> frees;
+
+    bool IsFreed(InstructionBase *alloc, Loop *loop);
+};
+} // namespace sc
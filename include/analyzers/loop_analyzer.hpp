@@ -0,0 +1,108 @@
+#pragma once
+
+#include "function.hpp"
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Natural loop of a back edge, see Cooper and Torczon Ch 9.5. All the
+ * back edges to the same header form a single loop. Blocks are kept in
+ * function order with the header first.
+ */
+class Loop {
+  public:
+    Loop(Block *_header) : header(_header), preheader(nullptr), parent(nullptr) {}
+
+    Block *GetHeader() const { return header; }
+
+    // Single block outside the loop whose only successor is the header.
+    // nullptr when the header is the entry block.
+    Block *GetPreheader() const { return preheader; }
+
+    // Blocks inside the loop with an edge to the header
+    const std::vector<Block *> &GetLatches() const { return latches; }
+
+    // Blocks outside the loop with an edge from inside the loop
+    const std::vector<Block *> &GetExits() const { return exits; }
+
+    const std::vector<Block *> &GetBlocks() const { return blocks; }
+
+    bool Contains(Block *block) const { return members.contains(block); }
+
+    bool Contains(const Loop *loop) const {
+        return Contains(loop->GetHeader());
+    }
+
+    Loop *GetParent() const { return parent; }
+
+    const std::vector<Loop *> &GetSubLoops() const { return subloops; }
+
+    // Outermost loops have depth 1
+    size_t GetDepth() const { return parent ? parent->GetDepth() + 1 : 1; }
+
+    void Dump(std::ostream &out = std::cout) const;
+
+  private:
+    Block *header;
+    Block *preheader;
+    Loop *parent;
+    std::vector<Block *> latches;
+    std::vector<Block *> exits;
+    std::vector<Block *> blocks;
+    std::unordered_set<Block *> members;
+    std::vector<Loop *> subloops;
+
+    friend class LoopAnalyzer;
+};
+
+/*
+ * Finds the natural loops of a function and arranges them in a loop-nest
+ * forest. Back edges are edges whose target dominates their source, so
+ * irreducible cycles are not reported as loops. Every loop gets a
+ * preheader, inserted right before the header when it doesn't have one,
+ * hence the analysis changes the CFG; it works both before and after SSA
+ * construction since the sets of the outside predecessors stay in place.
+ */
+class LoopAnalyzer {
+  public:
+    LoopAnalyzer(Function *f) : func(f) {}
+
+    void Analyze();
+
+    const std::vector<Loop *> &GetTopLevelLoops() const { return top_level; }
+
+    // Inner loops come before the loops containing them
+    std::vector<Loop *> GetLoopsInnermostFirst() const;
+
+    // Innermost loop containing block, nullptr if none
+    Loop *GetLoopFor(Block *block) const {
+        auto it = innermost.find(block);
+        return it == innermost.end() ? nullptr : it->second;
+    }
+
+    size_t GetLoopDepth(Block *block) const {
+        auto *loop = GetLoopFor(block);
+        return loop ? loop->GetDepth() : 0;
+    }
+
+    size_t GetLoopSize() const { return loops.size(); }
+
+    void DumpLoops(std::ostream &out = std::cout) const;
+
+  private:
+    Function *func;
+    std::vector<std::unique_ptr<Loop>> loops;
+    std::vector<Loop *> top_level;
+    std::unordered_map<Block *, Loop *> innermost;
+
+    void FindLoops();
+    void BuildForest();
+    void InsertPreheader(Loop *loop);
+    void ComputeExits(Loop *loop);
+};
+} // namespace sc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "function.hpp"
+#include "instruction.hpp"
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Node of Memory SSA, the whole memory is a single variable:
+ *
+ *   - ENTRY, the memory when the function is entered.
+ *   - DEF, a store, free or call that may write memory.
+ *   - USE, a load, a call that only reads memory or a ret, where the
+ *     caller can read the memory.
+ *   - PHI, the merge of the memory of the predecessors of a block.
+ */
+struct MemoryAccess {
+    enum class Kind { ENTRY, DEF, USE, PHI };
+
+    Kind kind;
+    // Position in the order the accesses were created, names it in dumps
+    size_t id;
+    Block *block = nullptr;
+    InstructionBase *instr = nullptr;
+    // Memory a DEF or a USE sees
+    MemoryAccess *defining = nullptr;
+    // Memory a PHI merges, by predecessor
+    std::vector<std::pair<Block *, MemoryAccess *>> incoming;
+    // Accesses whose defining access or incoming memory this is
+    std::vector<MemoryAccess *> users;
+};
+
+/*
+ * Memory SSA of a function in SSA form, layered over the gets and sets
+ * of the variables, see Novillo, Memory SSA - A Unified Approach for
+ * Sparsely Representing Memory Operations. Phis are placed on the
+ * iterated dominance frontier of the DEFs and renamed over the dominator
+ * tree like SSATransformer does with the variables. Calls are classified
+ * by the callee summaries, calls to pure functions don't touch memory.
+ *
+ * Only the instructions are looked at, so it isn't cached on the
+ * function, passes that change memory instructions recompute it.
+ */
+class MemorySSAAnalyzer {
+  public:
+    MemorySSAAnalyzer(Function *f) : func(f), dom(f) {}
+
+    void Analyze();
+
+    // nullptr for instructions that don't touch memory
+    MemoryAccess *GetAccess(InstructionBase *instr) const {
+        auto it = accesses.find(instr);
+        return it == accesses.end() ? nullptr : it->second;
+    }
+
+    // nullptr for blocks without a phi
+    MemoryAccess *GetPhi(Block *block) const {
+        auto it = phis.find(block);
+        return it == phis.end() ? nullptr : it->second;
+    }
+
+    MemoryAccess *GetEntry() const { return entry; }
+
+    // Closest access above access that may have written the value loaded
+    // from p: a DEF that may modify it, a PHI or the ENTRY. Stops at phis,
+    // so p has the same value wherever the walk goes.
+    MemoryAccess *GetClobber(MemoryAccess *access, OperandBase *p,
+                             const AliasAnalyzer &aa) const;
+
+    // Whether the access of a is executed before the access of b
+    // whenever b is
+    bool Dominates(InstructionBase *a, InstructionBase *b) const;
+
+    void DumpMemorySSA(std::ostream &out = std::cout) const;
+
+  private:
+    Function *func;
+    DominatorAnalyzer dom;
+    std::vector<std::unique_ptr<MemoryAccess>> nodes;
+    std::unordered_map<InstructionBase *, MemoryAccess *> accesses;
+    std::unordered_map<Block *, MemoryAccess *> phis;
+    MemoryAccess *entry = nullptr;
+
+    // std::nullopt for instructions that don't touch memory
+    std::optional<MemoryAccess::Kind> Classify(InstructionBase *instr) const;
+    MemoryAccess *NewAccess(MemoryAccess::Kind kind, Block *block,
+                            InstructionBase *instr = nullptr);
+    void PlacePhis();
+    void Rename(Block *block, MemoryAccess *current);
+    static void Link(MemoryAccess *user, MemoryAccess *def);
+    static std::string GetName(const MemoryAccess *access);
+};
+} // namespace sc
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "analyzers/dominator_analyzer.hpp"
+#include "function.hpp"
+#include "instruction.hpp"
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Closed interval of the values an int or a bool, as 0 or 1, may hold.
+ */
+struct Range {
+    int64_t lo = std::numeric_limits<int64_t>::min();
+    int64_t hi = std::numeric_limits<int64_t>::max();
+
+    static Range Of(int64_t value) { return {value, value}; }
+
+    bool IsConstant() const { return lo == hi; }
+
+    bool Contains(int64_t value) const { return lo <= value && value <= hi; }
+
+    bool operator==(const Range &) const = default;
+};
+
+/*
+ * Value range analysis of a function in SSA form, see Harrison, Compiler
+ * Analysis of the Value Ranges for Variables. Ranges flow through the
+ * arithmetic, the comparisons and the gets from the sets of the edges
+ * that may be taken, like SSCPTransformer the edges whose condition is
+ * known are never followed. Every br also bounds the operands of its
+ * condition in the blocks only its true or false edge leads to, so a
+ * value has a range at its definition and a narrower one below the
+ * branches testing it.
+ *
+ * Arithmetic that may overflow gives the full range. The gets of the
+ * loops are widened to the full range on the side still growing after a
+ * few rounds and narrowed back by recomputing every value afterwards.
+ * A value with no range, std::nullopt, is never computed on a path that
+ * may be taken; undef values have none either, reading them is an error.
+ *
+ * Only the instructions are looked at, so it isn't cached on the function.
+ */
+class RangeAnalyzer {
+  public:
+    RangeAnalyzer(Function *f) : func(f), dom(f) {}
+
+    void Analyze();
+
+    // Range at the definition, std::nullopt for values that aren't int or
+    // bool or are never computed
+    std::optional<Range> GetRange(OperandBase *op) const;
+
+    // Range in block, bounded by the branches the block is below
+    std::optional<Range> GetRange(OperandBase *op, Block *block) const;
+
+    bool IsExecutable(Block *block) const { return executable.contains(block); }
+
+    // Whether the edge from block to succ may be taken
+    bool IsExecutable(Block *block, Block *succ) const;
+
+    void DumpRanges(std::ostream &out = std::cout) const;
+
+  private:
+    enum class Relation { EQ, NE, LT, LE, GT, GE };
+
+    /*
+     * What an edge tells about a value in the blocks below it: op
+     * relation other, or op == value when other is nullptr.
+     */
+    struct Constraint {
+        OperandBase *op;
+        Relation relation;
+        OperandBase *other;
+        int64_t value;
+    };
+
+    Function *func;
+    DominatorAnalyzer dom;
+    std::vector<Block *> rpo;
+    std::unordered_map<OperandBase *, Range> ranges;
+    std::unordered_set<Block *> executable;
+    // Constraints of the edge into a block with a single predecessor
+    std::unordered_map<Block *, std::vector<Constraint>> constraints;
+    // Number of times the range of a get grew
+    std::unordered_map<InstructionBase *, size_t> grown;
+
+    void FindConstraints();
+    void AddConstraints(Block *block, OperandBase *cond, bool taken);
+    // Propagates the ranges over the blocks that may be executed, returns
+    // whether any changed
+    bool Propagate(bool widen);
+    std::optional<Range> Evaluate(InstructionBase *instr) const;
+    std::optional<Range> EvaluateGet(GetInstruction *instr) const;
+    static std::optional<Range> Apply(Range range, Relation relation,
+                                      Range other);
+};
+} // namespace sc
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "analyzers/call_graph_analyzer.hpp"
+#include "function.hpp"
+#include "program.hpp"
+#include <iostream>
+#include <unordered_map>
+
+namespace sc {
+
+/*
+ * Interprocedural summary of the effects of every function of a program.
+ * The local effects of a function are its loads, stores, prints, allocs
+ * and frees, and whether it may not return: a cycle of its CFG or of
+ * the call graph may not terminate, a div or a load may trap. Its
+ * summary adds the summaries of its callees. Functions
+ * are summarized bottom-up on the call graph, the summaries of a
+ * strongly connected component are iterated until they don't change.
+ * A call to a function the program doesn't define may do anything.
+ */
+class SummaryAnalyzer {
+  public:
+    SummaryAnalyzer(Program *p) : program(p) {}
+
+    void Analyze();
+
+    const FunctionSummary &GetSummary(Function *func) const {
+        return summaries.at(func);
+    }
+
+    const CallGraphAnalyzer &GetCallGraph() const { return cg; }
+
+    void DumpSummaries(std::ostream &out = std::cout) const;
+
+  private:
+    Program *program;
+    CallGraphAnalyzer cg{program};
+    std::unordered_map<Function *, FunctionSummary> summaries;
+
+    FunctionSummary Summarize(Function *func) const;
+};
+
+// Whole-program stage of the pipeline, every function keeps the
+// summaries of the functions it calls for the passes that follow.
+void SummarizeCalls(Program *program);
+} // namespace sc
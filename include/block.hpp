@@ -65,7 +65,7 @@ class Block {
         }
 
         instr->SetBlock(this);
-        instr->SetIndex(instructions.size());
+        instr->SetIndex(idx);
         instructions[idx] = std::move(instr);
     }
 
@@ -133,6 +133,18 @@ class Block {
         FixIndex(0);
     }
 
+    instr_ptr ReleaseInstruction(size_t idx) {
+        /*
+         * Removes the instruction at idx keeping its def-use links
+         */
+        assert(idx < instructions.size());
+        auto instr = std::move(instructions[idx]);
+        instructions.erase(instructions.begin() + static_cast<long>(idx));
+        instr->SetBlock(nullptr);
+        FixIndex(idx);
+        return instr;
+    }
+
     std::vector<instr_ptr> ReleaseInstructions() {
         std::ranges::for_each(instructions,
                               [](instr_ptr &ptr) { ptr->SetBlock(nullptr); });
@@ -211,11 +223,21 @@ class Block {
     /*
      * Dump
      */
-    void Dump(std::ostream &out = std::cout, std::string prefix = "") const {
+    // A jmp to next, the block printed right after this one, falls
+    // through and is left out
+    void Dump(std::ostream &out = std::cout, std::string prefix = "",
+              const Block *next = nullptr) const {
         for (auto &i : instructions) {
-            if (i->GetOpcode() != Opcode::GETARG) {
-                i->Dump(out << prefix);
+            if (i->GetOpcode() == Opcode::GETARG) {
+                continue;
+            }
+            if (next && i->GetOpcode() == Opcode::JMP &&
+                static_cast<JmpInstruction *>(i.get())
+                        ->GetJmpDest()
+                        ->GetBlock() == next) {
+                continue;
             }
+            i->Dump(out << prefix);
         }
     }
 
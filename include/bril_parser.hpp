@@ -5,6 +5,7 @@
 #include "operand.hpp"
 #include "program.hpp"
 // system includes
+#include <functional>
 #include <memory>
 #include <ranges>
 #include <string>
@@ -19,8 +20,16 @@ using FuncPtr = std::unique_ptr<Function>;
 
 class BrilParser {
   public:
+    // Function bodies are parsed concurrently and added to the program
+    // in source order.
     static std::unique_ptr<Program> ParseProgram(std::istream &program);
 
+    // Builds the IR one function at a time and hands each function to
+    // callback as soon as it is parsed. The JSON of a function is released
+    // before the next one is read.
+    static void StreamProgram(std::istream &program,
+                              std::function<void(FuncPtr)> callback);
+
   private:
     BrilParser() {}
 
@@ -31,6 +40,9 @@ class BrilParser {
     // Temp label store to help with the parsing
     LabelStore lbl_store;
 
+    // Parses the JSON text of a single function
+    static FuncPtr ParseFunction(const std::string &text);
+
     FuncPtr ParseFunction(sjp::Json &jfunc);
     FuncPtr ParseArguments(FuncPtr func, sjp::Json &args);
     FuncPtr ParseBody(FuncPtr func, sjp::Json &instrs);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "function.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sc {
+
+/*
+ * Persistent cache of optimized functions.
+ *
+ * Entries live in a directory, one file per function, named after a hash
+ * of the function's IR and of the pipeline configuration. Lookups
+ * refresh the modification time of the entry so that, once the directory
+ * grows past its size limit, the least recently used entries are evicted
+ * first. Entries are written to a temporary file and renamed in place, so
+ * several compiler processes can share a directory. A single instance
+ * may be used from several threads.
+ */
+class CompileCache {
+  public:
+    CompileCache(std::filesystem::path _dir, std::string _config,
+                 uintmax_t _max_size);
+
+    // Key for a function the whole-program stages (inline, ipsccp, ipa)
+    // have run on but no later stage. It covers the IR of the function and
+    // the summaries of its callees.
+    std::string GetKey(Function *func) const;
+
+    std::optional<std::string> Lookup(const std::string &key);
+
+    void Store(const std::string &key, const std::string &text);
+
+    struct Digest {
+        uint64_t hi;
+        uint64_t lo;
+
+        bool operator==(const Digest &) const = default;
+    };
+
+    // 128 bit FNV-1a, seed is the digest of the data hashed before
+    static Digest Hash(std::string_view data,
+                       Digest seed = {0x6c62272e07bb0142, 0x62b821756295c58d});
+
+  private:
+    std::filesystem::path dir;
+    std::string config;
+    uintmax_t max_size;
+    uintmax_t size;
+    std::mutex mtx;
+
+    void Evict();
+};
+} // namespace sc
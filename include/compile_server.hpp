@@ -0,0 +1,56 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace sc {
+
+/*
+ * Resident compiler that serves requests over a unix domain socket or a
+ * pair of file descriptors. A request is a 32 bit length followed by the
+ * JSON text of a program. The reply is a status byte (0 on success), a 32
+ * bit length and either the compiled program or the error message. A
+ * frame longer than 256 MiB ends the connection.
+ *
+ * Requests are compiled on a thread pool that is started once, so the
+ * process startup and static initialization are paid a single time. A
+ * connection waiting for its next request doesn't hold a worker.
+ */
+class CompileServer {
+  public:
+    using CompileFn = std::function<std::string(std::istream &)>;
+
+    CompileServer(CompileFn _compile, size_t threads, bool _time = false)
+        : compile(std::move(_compile)), pool(threads), time(_time) {}
+
+    // Accepts connections on path until the process is terminated. Each
+    // connection may send several requests one after another, they're
+    // served like those of Serve(in, out).
+    void Serve(const std::string &path);
+
+    // Serves the requests read from in, replies are written to out in the
+    // order of the requests.
+    void Serve(int in, int out);
+
+  private:
+    struct Reply {
+        bool ok;
+        std::string text;
+    };
+
+    CompileFn compile;
+    ThreadPool pool;
+    bool time;
+
+    Reply Compile(const std::string &request);
+};
+
+// Sends program to the server listening on path and writes the compiled
+// program to out, errors go to err. Returns false if the server can't be
+// reached or goes away before replying, otherwise status holds the exit
+// code.
+bool RunClient(const std::string &path, const std::string &program,
+               std::ostream &out, std::ostream &err, int &status);
+} // namespace sc
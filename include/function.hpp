@@ -3,10 +3,14 @@
 #include "block.hpp"
 #include "operand.hpp"
 #include "util.hpp"
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <ranges>
 #include <string>
+#include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 namespace sc {
@@ -17,6 +21,31 @@ namespace sc {
 
 class InstructionBase;
 
+// What a call to a function may do besides returning its value, computed
+// for the whole program by SummaryAnalyzer
+struct FunctionSummary {
+    enum Effect : uint8_t {
+        READS = 1 << 0,
+        WRITES = 1 << 1,
+        PRINTS = 1 << 2,
+        ALLOCATES = 1 << 3,
+        FREES = 1 << 4,
+        // May loop forever or trap instead of returning
+        DIVERGES = 1 << 5,
+        ALL = READS | WRITES | PRINTS | ALLOCATES | FREES | DIVERGES,
+    };
+    uint8_t effects = 0;
+
+    bool Has(Effect effect) const { return effects & effect; }
+
+    // The value only depends on the arguments and is always returned,
+    // calls with the same arguments are redundant
+    bool IsPure() const { return !effects; }
+
+    // Whether a call whose value is unused has to stay
+    bool HasSideEffects() const { return effects & ~READS; }
+};
+
 class Function {
   public:
     Function(std::string _name, DataType _ret_type)
@@ -68,6 +97,19 @@ class Function {
                std::views::transform([](auto &blk) { return blk.get(); });
     }
 
+    void InsertBlock(std::unique_ptr<Block> block, size_t idx) {
+        /*
+         * Moves the block at idx to idx + 1
+         */
+        assert(idx <= blocks.size());
+        blocks.insert(blocks.begin() + static_cast<long>(idx),
+                      std::move(block));
+
+        for (auto i : std::views::iota(idx, blocks.size())) {
+            blocks[i]->SetIndex(i);
+        }
+    }
+
     void RemoveBlock(size_t idx) {
         // Not efficient avoid using.
         // Use helper function in utils
@@ -88,10 +130,71 @@ class Function {
         }
     }
 
+    // Places the blocks in order, which holds every block of the function
+    void ReorderBlocks(const std::vector<Block *> &order) {
+        assert(order.size() == blocks.size());
+        std::vector<std::unique_ptr<Block>> reordered(blocks.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            assert(blocks[order[i]->GetIndex()]);
+            reordered[i] = std::move(blocks[order[i]->GetIndex()]);
+        }
+        blocks = std::move(reordered);
+
+        size_t i = 0;
+        for (auto &blk : blocks) {
+            blk->SetIndex(i++);
+        }
+    }
+
+    /*
+     * Analyses
+     */
+    // Analyses are computed on first use and shared by the passes that
+    // follow until a pass changes the CFG. An analysis is constructed
+    // from the function and computed by its Analyze().
+    template <typename T> T *GetAnalysis() {
+        auto it = analyses.find(typeid(T));
+        if (it != analyses.end()) {
+            return static_cast<T *>(it->second.get());
+        }
+
+        // Not inserted before Analyze since it may request other analyses
+        auto analysis = std::make_shared<T>(this);
+        analysis->Analyze();
+        analyses[typeid(T)] = analysis;
+        return analysis.get();
+    }
+
+    template <typename T> void InvalidateAnalysis() {
+        analyses.erase(typeid(T));
+    }
+
+    void InvalidateAnalyses() { analyses.clear(); }
+
+    /*
+     * Callee summaries
+     */
+    // A function compiled on its own only knows the callees summarized
+    // for it, a call to any other function may do anything.
+    void SetCalleeSummary(const std::string &callee, FunctionSummary summary) {
+        callee_summaries[callee] = summary;
+    }
+
+    const FunctionSummary *GetCalleeSummary(const std::string &callee) const {
+        auto it = callee_summaries.find(callee);
+        return it == callee_summaries.end() ? nullptr : &it->second;
+    }
+
+    const std::map<std::string, FunctionSummary> &GetCalleeSummaries() const {
+        return callee_summaries;
+    }
+
     /*
      * Dump
      */
-    void Dump(std::ostream &out = std::cout) const;
+    // With fallthrough a jmp to the block printed next is left out, as in
+    // the emitted program
+    void Dump(std::ostream &out = std::cout, bool fallthrough = false) const;
     void DumpBlocks(std::ostream &out = std::cout) const;
     void DumpCFG(std::ostream &out = std::cout) const;
     void DumpDefUseLinks(std::ostream &out = std::cout) const;
@@ -102,6 +205,9 @@ class Function {
     DataType ret_type;
     bool args;
     size_t args_size;
+    std::unordered_map<std::type_index, std::shared_ptr<void>> analyses;
+    // Ordered so that snapshots of the same function are identical
+    std::map<std::string, FunctionSummary> callee_summaries;
 };
 
 class PtrFunction final : public Function {
@@ -114,4 +220,26 @@ class PtrFunction final : public Function {
   private:
     std::vector<DataType> ptr_chain;
 };
+
+/*
+ * CFG editing helpers
+ */
+// Makes every edge from -> to go to new_to, the terminator of from is
+// updated as well.
+void RedirectEdge(Block *from, Block *to, Block *new_to);
+
+// Replaces the terminator of block with a jmp to target
+void ReplaceWithJmp(Block *block, Block *target);
+
+// Clones blocks and inserts the clones at idx named prefix + name. Edges
+// between the cloned blocks are redirected to the clones while the other
+// edges keep their targets. Only meaningful before SSA construction.
+std::unordered_map<Block *, Block *>
+CloneBlocks(Function *func, const std::vector<Block *> &blocks,
+            const std::string &prefix, size_t idx);
+
+// Copy of func named name with variables of its own. Only meaningful
+// before SSA construction.
+std::unique_ptr<Function> CloneFunction(Function *func,
+                                        const std::string &name);
 } // namespace sc
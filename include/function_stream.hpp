@@ -0,0 +1,33 @@
+#pragma once
+
+#include <istream>
+#include <string>
+
+namespace sc {
+
+/*
+ * Incremental reader for the top-level "functions" array of a Bril JSON
+ * program. It only tracks nesting and string state, so the text of a
+ * single function is held at a time. This lets the parser build the IR of
+ * one function and drop its JSON before the next one is read.
+ */
+class FunctionStream {
+  public:
+    FunctionStream(std::istream &_input) : input(_input) {}
+
+    // Copies the raw text of the next function object into text.
+    // Returns false once the functions array is exhausted.
+    bool Next(std::string &text);
+
+  private:
+    std::istream &input;
+    bool located = false;
+    bool done = false;
+
+    void Locate();
+    int Get();
+    int Peek();
+    void SkipWhitespace();
+    void ReadString(std::string *out);
+};
+} // namespace sc
@@ -380,6 +380,8 @@ class GetInstruction final : public InstructionBase {
 
     std::span<SetInstruction *> GetSetPairs() { return std::span(sets); }
 
+    void RemoveSetPair(SetInstruction *instr) { std::erase(sets, instr); }
+
   private:
     OperandBase *shadow;
     // There is atleast two set instr per get instr
@@ -597,6 +599,13 @@ class GetArgInstruction final : public InstructionBase {
 };
 
 // Helper functions
+// New instruction of the class implementing opcode
+std::unique_ptr<InstructionBase> MakeInstruction(Opcode opcode);
+
+// Copy of instr with the same dest, operands and targets. Def-use links
+// are not recorded, so it's only meaningful before SSA construction.
+std::unique_ptr<InstructionBase> CloneInstruction(InstructionBase *instr);
+
 // Only meaningful in SSA-form
 inline void SetDestAndDef(InstructionBase *instr, std::shared_ptr<OperandBase> oprnd) {
     oprnd->SetDef(instr);
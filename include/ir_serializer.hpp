@@ -0,0 +1,29 @@
+#pragma once
+
+#include "program.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace sc {
+
+/*
+ * Compact binary snapshot of the IR.
+ *
+ * A snapshot stores every function with its blocks, instructions, CFG
+ * edges, get/set pairs and def-use links, plus a constant pool shared by
+ * all functions. All fields are fixed width so loading is a single pass
+ * over a memory mapped file. The name of the last pass applied to the
+ * program is recorded so a driver can resume the pipeline after it.
+ */
+void WriteIR(Program *program, std::ostream &out, const std::string &stage);
+// Snapshot of a single function, loads as a program with one function
+void WriteIR(Function *func, std::ostream &out, const std::string &stage);
+void WriteIR(Program *program, const std::string &path,
+             const std::string &stage);
+
+std::unique_ptr<Program> LoadIR(const char *data, size_t size,
+                                std::string *stage = nullptr);
+std::unique_ptr<Program> LoadIR(const std::string &path,
+                                std::string *stage = nullptr);
+} // namespace sc
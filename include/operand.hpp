@@ -66,7 +66,11 @@ class OperandBase {
     /*
      * Use
      */
-    void SetUse(InstructionBase *instr) { uses.push_back(instr); }
+    void SetUse(InstructionBase *instr) {
+        if (tracked) {
+            uses.push_back(instr);
+        }
+    }
 
     size_t GetUsesSize() const { return uses.size(); }
 
@@ -85,8 +89,9 @@ class OperandBase {
     }
 
   protected:
-    OperandBase(DataType _type, std::string _name)
-        : type(_type), name(std::move(_name)), def(nullptr) {}
+    OperandBase(DataType _type, std::string _name, bool _tracked = true)
+        : type(_type), name(std::move(_name)), def(nullptr),
+          tracked(_tracked) {}
 
     DataType type;
     std::string name;
@@ -94,6 +99,10 @@ class OperandBase {
     // ssa-form single def
     InstructionBase *def;
     std::vector<InstructionBase *> uses;
+
+    // Immediates and sentinels are shared by every function
+    // so their uses are not recorded.
+    bool tracked;
 };
 
 class RegOperand : public OperandBase {
@@ -140,7 +149,8 @@ template <typename C> class ImmedOperand : public OperandBase {
         throw std::runtime_error("ImmedOperand cannot be cloned.\n");
     }
 
-    ImmedOperand(DataType type, std::string name) : OperandBase(type, name) {}
+    ImmedOperand(DataType type, std::string name)
+        : OperandBase(type, name, false) {}
 };
 
 class IntOperand final : public ImmedOperand<IntOperand> {
@@ -203,7 +213,7 @@ class UndefOperand : public OperandBase {
         throw std::runtime_error("UndefOperand cannot be cloned.\n");
     }
 
-    UndefOperand() : OperandBase(DataType::VOID, "__undef__") {}
+    UndefOperand() : OperandBase(DataType::VOID, "__undef__", false) {}
 };
 
 // Void Sentinel Singleteon
@@ -224,7 +234,7 @@ class VoidOperand : public OperandBase {
         throw std::runtime_error("VoidOperand cannot be cloned.\n");
     }
 
-    VoidOperand() : OperandBase(DataType::VOID, "__void__") {}
+    VoidOperand() : OperandBase(DataType::VOID, "__void__", false) {}
 };
 
 } // namespace sc
@@ -22,9 +22,9 @@ class Program {
     // non-owning pointer
     Function *GetFunction(size_t idx) { return functions[idx].get(); }
 
-    void Dump(std::ostream &out = std::cout) {
+    void Dump(std::ostream &out = std::cout, bool fallthrough = false) {
         for (auto &f : functions) {
-            f->Dump(out);
+            f->Dump(out, fallthrough);
         }
     }
 
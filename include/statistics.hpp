@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace sc {
+
+/*
+ * Named counters collected while compiling, e.g. cache hits or the
+ * number of instructions a pass removed. Counters are process wide and
+ * can be bumped from several threads. Counters that cost an analysis of
+ * their own are only collected once enabled, e.g. by --stats.
+ */
+class Statistics {
+  public:
+    static Statistics &Get();
+
+    void Add(const std::string &name, size_t count = 1);
+
+    size_t GetCount(const std::string &name) const;
+
+    void Reset();
+
+    void SetEnabled(bool enable) { enabled = enable; }
+
+    bool IsEnabled() const { return enabled; }
+
+    void Dump(std::ostream &out = std::cerr) const;
+
+  private:
+    Statistics() = default;
+
+    std::atomic<bool> enabled = false;
+    mutable std::mutex mtx;
+    std::map<std::string, size_t> counters;
+};
+} // namespace sc
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sc {
+
+// Fixed set of worker threads that run tasks in submission order.
+class ThreadPool {
+  public:
+    ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F &&task) {
+        using R = std::invoke_result_t<F>;
+        // std::function needs a copyable target
+        auto packaged =
+            std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        cv.notify_one();
+        return future;
+    }
+
+    size_t GetSize() const { return workers.size(); }
+
+  private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop = false;
+
+    void Work();
+};
+} // namespace sc
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/memory_ssa_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+
+namespace sc {
+
+/*
+ * Dead store elimination on Memory SSA. The memory written by a store is
+ * followed down its users: the store is live when an access that may read
+ * the location is reached before a store that must alias it overwrites
+ * it. A ret reads what the caller can reach, so stores into allocations
+ * that never leave the function are dead once nothing loads them.
+ *
+ * Past a phi the pointers may hold the values of another iteration, so
+ * only the objects are compared and nothing counts as overwriting.
+ */
+class DSETransformer final : public Transformer {
+  public:
+    DSETransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    AliasAnalyzer aa{func};
+    MemorySSAAnalyzer mssa{func};
+    size_t removed = 0;
+
+    bool IsDead(InstructionBase *store) const;
+};
+} // namespace sc
@@ -23,6 +23,8 @@ class DVNTransformer final : public Transformer {
 
     void Transform() override;
 
+    bool PreservesCFG() const override { return true; }
+
   private:
     DominatorAnalyzer dom;
     Interpreter interpreter;
@@ -62,6 +64,10 @@ class DVNTransformer final : public Transformer {
 
     void Process(InstructionBase *instr, size_t idx);
 
+    bool IsPureCall(InstructionBase *instr) const;
+
+    void ProcessCall(CallInstruction *call, size_t idx);
+
     bool IsUselessOrRedundant(GetInstruction *geti, std::string &key);
 
     void MarkForRemoval(Block *block, size_t idx);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "analyzers/lifetime_analyzer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "analyzers/range_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <memory>
+
+namespace sc {
+
+/*
+ * Hoists allocations out of loops on SSA form. An allocation of a
+ * loop-invariant size executed on every iteration and freed in the same
+ * iteration on every path never has two objects live at once, so the
+ * loop reuses a single object: the alloc moves to the preheader, its
+ * frees in the loop are removed and every exit of the loop frees it.
+ * Loops are visited innermost first, so an allocation can leave a nest.
+ * A loop may be left before its first allocation, the size then has to
+ * be valid in the preheader too: the alloc dominates the exits or the
+ * range of the size is positive.
+ *
+ * Exits with predecessors outside the loop would free objects the loop
+ * never allocated, such loops are left alone.
+ *
+ * With statistics enabled the allocations that stay are accounted for: the
+ * ones freed on every path, which a runtime could serve from pools or
+ * the frame of the call, and the ones that leak on some path since
+ * they are neither freed nor reachable from outside the function.
+ */
+class HoistAllocTransformer final : public Transformer {
+  public:
+    HoistAllocTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    LifetimeAnalyzer lifetimes{func};
+    // Computed on the first size not known to be positive
+    std::unique_ptr<RangeAnalyzer> ranges;
+    size_t hoisted = 0;
+
+    void Hoist(Loop *loop);
+
+    void Account();
+
+    bool CanHoist(Loop *loop, InstructionBase *alloc);
+
+    // Whether alloc would allocate in the preheader whenever the loop is
+    // entered
+    bool IsValidSize(Loop *loop, InstructionBase *alloc);
+};
+} // namespace sc
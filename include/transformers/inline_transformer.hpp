@@ -0,0 +1,53 @@
+#pragma once
+
+#include "analyzers/call_graph_analyzer.hpp"
+#include "instruction.hpp"
+#include "program.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace sc {
+
+/*
+ * Inlines calls to small functions of the program before SSA
+ * construction, see Cooper and Torczon Ch 8.7.1. Functions are visited
+ * bottom-up on the call graph so a callee is inlined with the calls it
+ * inlined itself, calls inside a strongly connected component are
+ * recursive and left alone.
+ *
+ * The blocks of the callee are cloned into the caller with their
+ * variables renamed, the arguments are copied into the parameters and
+ * the returned value into the destination of the call. The rest of the
+ * pipeline then optimizes the caller with the inlined code.
+ */
+class InlineTransformer {
+  public:
+    InlineTransformer(Program *p) : program(p) {}
+
+    void Transform();
+
+  private:
+    // Size in instructions of the callees inlined anywhere, calls in
+    // loops inline callees up to loop_factor times larger. A caller
+    // stops growing at max_caller_size.
+    static constexpr size_t max_size = 16;
+    static constexpr size_t loop_factor = 4;
+    static constexpr size_t max_caller_size = 2048;
+
+    Program *program;
+    CallGraphAnalyzer cg{program};
+    std::unordered_map<Function *, size_t> sizes;
+    size_t count = 0;
+    size_t inlined = 0;
+
+    void InlineCalls(Function *func);
+
+    void Inline(Function *func, CallInstruction *call, Function *callee);
+
+    static size_t GetSize(Function *func);
+};
+
+// Whole-program stage of the pipeline
+void Inline(Program *program);
+} // namespace sc
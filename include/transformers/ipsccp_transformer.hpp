@@ -0,0 +1,101 @@
+#pragma once
+
+#include "analyzers/call_graph_analyzer.hpp"
+#include "instruction.hpp"
+#include "program.hpp"
+#include "transformers/sscp_transformer.hpp"
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Interprocedural sparse conditional constant propagation before SSA
+ * construction, see Cooper and Torczon Ch 9.4 and Wegman and Zadeck.
+ * Every function is propagated over its executable edges with the lattice
+ * of SSCPTransformer. The arguments of a function are the meet of the
+ * arguments of its executable calls, and the value of a call is the meet
+ * of the values the callee returns. A function is propagated again when
+ * its arguments or the values of its calls go down the lattice.
+ *
+ * A call passing constants that disagree with the other calls of a small
+ * non-recursive callee is redirected to a copy of the callee specialized
+ * for those constants, and the program is propagated again. Values found
+ * constant become const instructions and branches on constants become
+ * jumps, CFTransformer removes the code that became unreachable.
+ */
+class IPSCCPTransformer {
+  public:
+    IPSCCPTransformer(Program *p) : program(p) {}
+
+    void Transform();
+
+    // Immediate computed by opcode from immediate operands, nullptr when
+    // it traps
+    static OperandBase *Fold(Opcode opcode,
+                             const std::vector<OperandBase *> &ops);
+
+  private:
+    // Callees specialized are at most max_size instructions large, and
+    // copied at most max_clones times. Specializing a copy may make the
+    // calls in it constant, up to max_rounds times.
+    static constexpr size_t max_size = 64;
+    static constexpr size_t max_clones = 4;
+    static constexpr size_t max_rounds = 3;
+
+    struct Value {
+        LVT type = LVT::UNKNOWN;
+        OperandBase *constant = nullptr;
+
+        bool operator==(const Value &) const = default;
+    };
+
+    // Values of the variables at a point of a function, a missing variable
+    // is LVT::UNKNOWN
+    using State = std::unordered_map<OperandBase *, Value>;
+
+    Program *program;
+    CallGraphAnalyzer cg{program};
+    std::unordered_map<Function *,
+                       std::vector<std::pair<Function *, CallInstruction *>>>
+        callers;
+    std::deque<Function *> worklist;
+    std::unordered_set<Function *> queued;
+
+    std::unordered_map<Function *, std::vector<Value>> args;
+    std::unordered_map<Function *, Value> rets;
+    // Arguments of the executable calls
+    std::unordered_map<CallInstruction *, std::vector<Value>> call_args;
+    // Value of the dest of every executable instruction, and of the
+    // condition of every executable branch
+    std::unordered_map<InstructionBase *, Value> values;
+    std::unordered_set<Block *> executable;
+
+    // Copies of a function by the constants they are specialized for
+    std::map<std::pair<Function *, std::vector<OperandBase *>>, Function *>
+        specs;
+    std::unordered_map<Function *, size_t> clones;
+    size_t count = 0;
+    size_t specialized = 0;
+    size_t constants = 0;
+    size_t branches = 0;
+
+    void Analyze();
+    void Propagate(Function *func);
+    void Enqueue(Function *func);
+
+    bool Specialize();
+    bool Rewrite(Function *func);
+
+    Value Evaluate(InstructionBase *instr, const State &state) const;
+    static Value Lookup(const State &state, OperandBase *op);
+    static Value Meet(const Value &a, const Value &b);
+};
+
+// Whole-program stage of the pipeline
+void PropagateConstants(Program *program);
+} // namespace sc
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "analyzers/dominator_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <optional>
+#include <unordered_map>
+
+namespace sc {
+
+/*
+ * Jump threading before SSA construction. The branch of a block is known
+ * on an edge into it when the constants assigned by the predecessor, or
+ * the branch that led to the predecessor or to the block itself, decide
+ * its condition. The block is copied for such edges with a jmp to the
+ * successor taken in place of the branch, so the test is no longer
+ * executed on that path. CFTransformer then merges the copies into their
+ * predecessors and removes the blocks no edge reaches anymore.
+ *
+ * Only small blocks are copied and the copies are limited per function.
+ * Loop headers are never threaded, a copy would become a second entry
+ * into the loop.
+ */
+class JumpThreadTransformer final : public Transformer {
+  public:
+    JumpThreadTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+  private:
+    // Limits on the instructions of a copied block and on the
+    // instructions copied in a function
+    static constexpr size_t max_size = 8;
+    static constexpr size_t max_growth = 64;
+
+    // Immediate value of the variables at a point of a block
+    using State = std::unordered_map<OperandBase *, OperandBase *>;
+
+    DominatorAnalyzer *dom = nullptr;
+    size_t growth = 0;
+    size_t copies = 0;
+    size_t edges = 0;
+
+    // Threads the edges into block whose branch is known, returns whether
+    // any was
+    bool Thread(Block *block);
+
+    // Whether the branch of block goes to its true successor when entered
+    // from pred, std::nullopt when it's not known
+    std::optional<bool> GetDirection(Block *pred, Block *block) const;
+
+    static void Learn(State &state, Block *from, Block *to);
+    static void Simulate(State &state, Block *block);
+};
+} // namespace sc
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "analyzers/loop_analyzer.hpp"
+#include "transformer.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Basic block placement, see Pettis and Hansen, Profile Guided Code
+ * Positioning. The edges are visited from the most to the least frequent
+ * and an edge joins the chain ending at its source to the chain starting
+ * at its target, so the target falls through from the source. The chains
+ * are then laid out from the hottest to the coldest, the entry first.
+ * The emitted program leaves out the jmps to the block printed next.
+ *
+ * There's no profile to read, the frequencies are estimated: a loop runs
+ * loop_scale times per entry, its back edges are likely and its exits
+ * unlikely, the other branches go either way.
+ */
+class LayoutTransformer final : public Transformer {
+  public:
+    LayoutTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+  private:
+    static constexpr double loop_scale = 8;
+    static constexpr double likely = 7.0 / 8;
+
+    struct Edge {
+        Block *from;
+        Block *to;
+        double weight;
+    };
+
+    LoopAnalyzer *loops = nullptr;
+
+    double GetFrequency(Block *block) const;
+    std::vector<Edge> GetEdges() const;
+
+    // Probability of the edge from block to succ, one of its successors
+    double GetProbability(Block *block, Block *succ) const;
+};
+} // namespace sc
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <unordered_set>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Loop-invariant code motion on SSA form, see Cooper and Torczon Ch 10.3.
+ * Loops are visited innermost first, so a computation hoisted into the
+ * preheader of an inner loop can leave the enclosing loops as well.
+ *
+ * Pure computations are always hoisted. Instructions that may trap (int
+ * division by a non-constant and loads) are only hoisted from blocks that
+ * execute on every trip through the loop, loads additionally require that
+ * no store, call or free of the loop may modify the loaded location
+ * according to AliasAnalyzer.
+ */
+class LICMTransformer final : public Transformer {
+  public:
+    LICMTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    DominatorAnalyzer *dom = nullptr;
+    AliasAnalyzer aa{func};
+    size_t hoisted = 0;
+    size_t hoisted_loads = 0;
+
+    void Hoist(Loop *loop);
+
+    bool IsInvariant(Loop *loop, InstructionBase *instr) const;
+
+    bool IsSafeToHoist(Loop *loop, InstructionBase *instr,
+                       const std::vector<Block *> &exiting,
+                       const std::vector<InstructionBase *> &writes) const;
+
+    // Stores, calls and frees of the loop
+    std::vector<InstructionBase *> GetWrites(Loop *loop) const;
+};
+} // namespace sc
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "analyzers/dominator_analyzer.hpp"
+#include "analyzers/induction_analyzer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Operator strength reduction on SSA form, see Cooper, Simpson and Vick,
+ * Operator Strength Reduction, and Cooper and Torczon Ch 10.7.2.
+ *
+ * A multiplication of an induction variable by a region constant, or an
+ * address ptradd rc iv, is replaced by a new induction variable that
+ * mirrors the get/set cycle of the old one and steps by the scaled
+ * increments. Additions are only reduced when they feed one of those.
+ * Linear-function test replacement then rewrites the loop tests on an
+ * induction variable whose other uses are gone to test the new one, so
+ * DCE can remove the old cycle.
+ */
+class OSRTransformer final : public Transformer {
+  public:
+    OSRTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    // Position of a value in the members of an induction variable
+    using Member = std::pair<const InductionVariable *, size_t>;
+    // Value computed from (value, opcode, region constant) before an
+    // instruction, or in the preheader
+    using Key = std::tuple<const OperandBase *, Opcode, const OperandBase *,
+                           const InstructionBase *>;
+
+    // result = iv op rc
+    struct Reduction {
+        const InductionVariable *iv;
+        Opcode op;
+        OperandBase *rc;
+        const InductionVariable *result;
+    };
+
+    Loop *loop = nullptr;
+    DominatorAnalyzer *dom = nullptr;
+    // Where Apply and Constant insert, the end of the preheader when null
+    InstructionBase *position = nullptr;
+    std::unordered_map<OperandBase *, Member> members;
+    std::list<InductionVariable> created;
+    std::vector<Reduction> reduced;
+    std::map<Key, OperandBase *> applied;
+    std::unordered_set<InstructionBase *> live;
+    size_t count = 0;
+    size_t reductions = 0;
+    size_t replacements = 0;
+
+    bool ReduceLoop(InductionAnalyzer &iva);
+
+    const InductionVariable *Reduce(const InductionVariable *iv, Opcode op,
+                                    OperandBase *rc);
+
+    // Whether the values entering iv from outside the loop can be scaled by
+    // rc where they are set
+    bool CanReduce(const InductionVariable *iv, OperandBase *rc) const;
+
+    OperandBase *Apply(Opcode op, OperandBase *value, OperandBase *rc);
+
+    OperandBase *Constant(ValType::INT value, OperandBase *type);
+
+    InstructionBase *Insert(std::unique_ptr<InstructionBase> instr);
+
+    std::shared_ptr<OperandBase> NewValue(OperandBase *type);
+
+    void MarkLive();
+
+    void ReplaceTests(const InductionVariable *iv);
+};
+} // namespace sc
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "instruction.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include <array>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Rewrite rules over SSA values, declared as types:
+ *
+ *   Rule<Inst<Opcode::SUB, Var<0>, Var<0>>, IntConst<0>>
+ *
+ * A pattern is a tree of Inst, whose operands are themselves patterns
+ * matched against their definitions, with Var binding a value and Int and
+ * Bool matching constants. A variable appearing twice matches the same
+ * value twice. The operands of commutative opcodes match in either order,
+ * and a failed match backtracks into the orders not tried yet.
+ *
+ * PeepholeRules sorts the rules by the opcode of their root at compile
+ * time, an instruction is only tried against the rules of its opcode.
+ */
+namespace peephole {
+
+// Values bound by the variables of a pattern
+using Bindings = std::array<OperandBase *, 4>;
+
+constexpr bool IsCommutative(Opcode opcode) {
+    return opcode == Opcode::ADD || opcode == Opcode::MUL ||
+           opcode == Opcode::EQ || opcode == Opcode::AND ||
+           opcode == Opcode::OR;
+}
+
+// Patterns begin
+// Any value, the same one everywhere N appears
+template <size_t N> struct Var {
+    static_assert(N < std::tuple_size_v<Bindings>);
+
+    template <typename K>
+    static bool Match(OperandBase *op, Bindings &b, K &&next) {
+        if (b[N]) {
+            return b[N] == op && next();
+        }
+        b[N] = op;
+        if (next()) {
+            return true;
+        }
+        b[N] = nullptr;
+        return false;
+    }
+};
+
+// Value of a const instruction
+template <ValType::INT V> struct Int {
+    template <typename K>
+    static bool Match(OperandBase *op, Bindings &, K &&next) {
+        auto *def = op->GetDef();
+        return def && def->GetOpcode() == Opcode::CONST &&
+               op->GetType() == DataType::INT &&
+               static_cast<IntOperand *>(def->GetOperand(0))->GetValue() ==
+                   V &&
+               next();
+    }
+};
+
+template <bool V> struct Bool {
+    template <typename K>
+    static bool Match(OperandBase *op, Bindings &, K &&next) {
+        auto *def = op->GetDef();
+        return def && def->GetOpcode() == Opcode::CONST &&
+               op->GetType() == DataType::BOOL &&
+               static_cast<BoolOperand *>(def->GetOperand(0))->GetValue() ==
+                   V &&
+               next();
+    }
+};
+
+// Value computed by an instruction of opcode Op
+template <Opcode Op, typename... Ps> struct Inst {
+    static constexpr Opcode opcode = Op;
+
+    template <typename K>
+    static bool Match(OperandBase *op, Bindings &b, K &&next) {
+        auto *def = op->GetDef();
+        return def && MatchInstruction(def, b, next);
+    }
+
+    template <typename K>
+    static bool MatchInstruction(InstructionBase *instr, Bindings &b,
+                                 K &&next) {
+        if (instr->GetOpcode() != Op ||
+            instr->GetOperandSize() != sizeof...(Ps)) {
+            return false;
+        }
+
+        Operands ops;
+        for (size_t i = 0; i < ops.size(); ++i) {
+            ops[i] = instr->GetOperand(i);
+        }
+        if (MatchOperands<0, Ps...>(ops, b, next)) {
+            return true;
+        }
+        if constexpr (sizeof...(Ps) == 2 && IsCommutative(Op)) {
+            std::swap(ops[0], ops[1]);
+            return MatchOperands<0, Ps...>(ops, b, next);
+        }
+        return false;
+    }
+
+  private:
+    using Operands = std::array<OperandBase *, sizeof...(Ps)>;
+
+    // Matches the operands from I on, continuing with next after the last
+    template <size_t I, typename P, typename... Rest, typename K>
+    static bool MatchOperands(const Operands &ops, Bindings &b, K &&next) {
+        return P::Match(ops[I], b, [&] {
+            if constexpr (sizeof...(Rest) == 0) {
+                return next();
+            } else {
+                return MatchOperands<I + 1, Rest...>(ops, b, next);
+            }
+        });
+    }
+};
+// Patterns end
+
+// Replacements of the root, called with the bindings of its match
+void ReplaceWithValue(InstructionBase *root, OperandBase *value);
+void ReplaceWithConst(InstructionBase *root, OperandBase *imm);
+void ReplaceWithInstruction(InstructionBase *root, Opcode opcode,
+                            const std::vector<OperandBase *> &ops);
+
+// Replacements begin
+// The value bound to N
+template <size_t N> struct Value {
+    static void Replace(InstructionBase *root, const Bindings &b) {
+        ReplaceWithValue(root, b[N]);
+    }
+};
+
+template <ValType::INT V> struct IntConst {
+    static void Replace(InstructionBase *root, const Bindings &) {
+        ReplaceWithConst(root, IntOperand::GetOperand(V));
+    }
+};
+
+template <bool V> struct BoolConst {
+    static void Replace(InstructionBase *root, const Bindings &) {
+        ReplaceWithConst(root, BoolOperand::GetOperand(V));
+    }
+};
+
+// An instruction of opcode Op on the values bound to Ns
+template <Opcode Op, size_t... Ns> struct New {
+    static void Replace(InstructionBase *root, const Bindings &b) {
+        ReplaceWithInstruction(root, Op, {b[Ns]...});
+    }
+};
+// Replacements end
+
+template <typename Pattern, typename Replacement> struct Rule {
+    static constexpr Opcode opcode = Pattern::opcode;
+
+    // Rewrites root when it matches, returns whether it did
+    static bool Apply(InstructionBase *root) {
+        Bindings b{};
+        if (!Pattern::MatchInstruction(root, b, [] { return true; })) {
+            return false;
+        }
+        Replacement::Replace(root, b);
+        return true;
+    }
+};
+
+using RuleFn = bool (*)(InstructionBase *);
+
+template <typename... Rules> class RuleTable {
+  public:
+    // Rules whose root is opcode, in the order they are declared
+    static std::span<const RuleFn> Lookup(Opcode opcode) {
+        auto i = static_cast<size_t>(opcode);
+        return std::span(rules).subspan(offsets[i],
+                                        offsets[i + 1] - offsets[i]);
+    }
+
+  private:
+    static constexpr size_t opcodes = static_cast<size_t>(Opcode::GETARG) + 1;
+    static constexpr std::array<Opcode, sizeof...(Rules)> roots = {
+        Rules::opcode...};
+    static constexpr std::array<RuleFn, sizeof...(Rules)> fns = {
+        &Rules::Apply...};
+
+    // Counting sort of the rules by opcode, stable so earlier rules are
+    // tried first
+    static constexpr std::array<size_t, opcodes + 1> offsets = [] {
+        std::array<size_t, opcodes + 1> offsets{};
+        for (auto opcode : roots) {
+            ++offsets[static_cast<size_t>(opcode) + 1];
+        }
+        for (size_t i = 1; i <= opcodes; ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+        return offsets;
+    }();
+
+    static constexpr std::array<RuleFn, sizeof...(Rules)> rules = [] {
+        std::array<RuleFn, sizeof...(Rules)> rules{};
+        auto next = offsets;
+        for (size_t i = 0; i < roots.size(); ++i) {
+            rules[next[static_cast<size_t>(roots[i])]++] = fns[i];
+        }
+        return rules;
+    }();
+};
+} // namespace peephole
+} // namespace sc
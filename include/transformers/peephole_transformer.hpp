@@ -0,0 +1,32 @@
+#pragma once
+
+#include "transformer.hpp"
+
+namespace sc {
+
+/*
+ * Peephole optimization on SSA form with the rules of peephole.hpp: the
+ * identities of add, sub, mul and div, comparisons of a value with
+ * itself, negated comparisons, boolean identities and the sums that undo
+ * a subtraction. The function is swept until no rule applies, a rewrite
+ * may expose another one in a later use.
+ *
+ * The rules keep the value of every program, there's no shift in bril so
+ * mul by a power of two only becomes adds for two.
+ */
+class PeepholeTransformer final : public Transformer {
+  public:
+    PeepholeTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    size_t rewritten = 0;
+
+    // Applies the first rule matching each instruction of block, returns
+    // whether any did
+    bool Sweep(Block *block);
+};
+} // namespace sc
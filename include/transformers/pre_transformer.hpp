@@ -0,0 +1,71 @@
+#pragma once
+
+#include "analyzers/dominator_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Partial redundancy elimination on SSA form in the style of GVN-PRE, see
+ * VanDrunen and Hosking, Value-Based Partial Redundancy Elimination, and
+ * Kennedy et al, Partial Redundancy Elimination in SSA Form.
+ *
+ * An expression in a join block is translated through the get/set pairs
+ * of the block into the expression computed on each incoming path. When
+ * it's available on some paths, it's computed on the others and a new
+ * get merges the values. An expression of a loop header that is
+ * available around the back edges only needs the computation inserted in
+ * the preheader, which is loop-invariant code motion as a special case.
+ *
+ * Gets and sets are executed like any other instruction, so an expression
+ * is only eliminated when no path executes more instructions than before,
+ * either because no get is needed or because the gets of its operands die
+ * with it.
+ */
+class PRETransformer final : public Transformer {
+  public:
+    PRETransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    // (opcode, operand, operand), the operands of a commutative
+    // expression in canonical order
+    using Key = std::tuple<Opcode, const OperandBase *, const OperandBase *>;
+
+    DominatorAnalyzer *dom = nullptr;
+    std::unordered_set<Block *> reachable;
+    std::map<Key, std::vector<InstructionBase *>> exprs;
+    size_t count = 0;
+    size_t eliminated = 0;
+    size_t inserted = 0;
+
+    void Eliminate(Block *block);
+
+    bool Eliminate(InstructionBase *instr, std::vector<GetInstruction *> &gets,
+                   const std::vector<Block *> &paths);
+
+    static bool IsCandidate(InstructionBase *instr);
+
+    static Key GetKey(InstructionBase *instr,
+                      const std::vector<OperandBase *> &ops);
+
+    // Is op defined before idx in block
+    bool IsAvailable(OperandBase *op, Block *block, size_t idx) const;
+
+    InstructionBase *FindAvailable(const Key &key, Block *block,
+                                   size_t idx) const;
+
+    void CollectExpressions();
+
+    std::shared_ptr<OperandBase> NewValue(OperandBase *type);
+};
+} // namespace sc
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Reassociation on SSA form, see Cooper and Torczon Ch 8.4.2 and Briggs
+ * and Cooper, Effective Partial Redundancy Elimination. The trees of
+ * add, mul, and and or whose inner values have no other use are
+ * flattened into their operands and rebuilt in a canonical order: by
+ * rank, the position of the definition in reverse postorder, with the
+ * constants folded together last. Values computed earlier, like the
+ * loop-invariant ones, are combined first, and the same sums and
+ * products come out the same for DVNTransformer however they were
+ * written.
+ *
+ * A value added three times or more becomes a mul by the count, and a
+ * mul by two an add of the value to itself, so x * 2 and x + x meet.
+ * Only trees within a block are flattened, nothing moves between blocks.
+ */
+class ReassociateTransformer final : public Transformer {
+  public:
+    ReassociateTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    std::unordered_map<OperandBase *, size_t> ranks;
+    size_t count = 0;
+    size_t rewritten = 0;
+
+    void Rank();
+    bool IsRoot(InstructionBase *instr) const;
+    void Flatten(InstructionBase *instr, std::vector<OperandBase *> &leaves,
+                 std::vector<InstructionBase *> &inner) const;
+    void Reassociate(InstructionBase *root);
+
+    // Instruction computing opcode of a and b, named after the rewritten
+    // tree unless dest is given
+    std::unique_ptr<InstructionBase>
+    NewInstruction(Opcode opcode, OperandBase *a, OperandBase *b,
+                   std::shared_ptr<OperandBase> dest,
+                   InstructionBase *root);
+    std::unique_ptr<InstructionBase> NewConstant(OperandBase *imm,
+                                                 InstructionBase *root);
+};
+} // namespace sc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/memory_ssa_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Redundant load elimination on Memory SSA. A load whose clobber, the
+ * closest access above it that may write the loaded location, is a store
+ * through a pointer that must alias it takes the stored value. Otherwise
+ * it takes the value of a dominating load of the same location with the
+ * same clobber, since nothing in between may have changed the memory.
+ *
+ * Blocks are visited in dominator tree order, so the loads that stay are
+ * seen before the loads they dominate.
+ */
+class RLETransformer final : public Transformer {
+  public:
+    RLETransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    AliasAnalyzer aa{func};
+    MemorySSAAnalyzer mssa{func};
+    // Loads that stay, by their clobber
+    std::unordered_map<MemoryAccess *, std::vector<InstructionBase *>>
+        available;
+    size_t forwarded = 0;
+    size_t redundant = 0;
+
+    // Value the load can be replaced with, nullptr if none
+    OperandBase *FindValue(InstructionBase *load);
+};
+} // namespace sc
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Scalar replacement of allocations before SSA construction, see Muchnick
+ * Ch 12.2. An allocation of a constant number of elements that doesn't
+ * escape, whose pointer and the pointers derived from it through ids and
+ * ptradds by constants are only loaded, stored through and freed, gets a
+ * variable per element. Loads become copies from the variable of their
+ * element, stores copies into it, and SSA construction turns the
+ * variables into registers. The alloc, the frees and the pointer
+ * arithmetic are removed.
+ *
+ * Before SSA a variable may be assigned more than once, so the sizes and
+ * indices must be variables assigned once by a const, and the pointers
+ * variables assigned once. An allocation in a loop is only replaced when
+ * all its accesses follow it in its block, otherwise objects of
+ * different iterations could be live at the same time.
+ */
+class SROATransformer final : public Transformer {
+  public:
+    SROATransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    bool PreservesCFG() const override { return true; }
+
+  private:
+    static constexpr int64_t max_elements = 16;
+
+    // Accesses of an allocation
+    struct Accesses {
+        // Loads and stores by the element they access
+        std::vector<std::pair<InstructionBase *, int64_t>> memory;
+        // The alloc, and the ids, ptradds and frees of its pointers
+        std::vector<InstructionBase *> removed;
+    };
+
+    std::unordered_map<OperandBase *, std::vector<InstructionBase *>> defs;
+    std::unordered_map<OperandBase *, std::vector<InstructionBase *>> uses;
+    size_t count = 0;
+    size_t promoted = 0;
+
+    // Value of a variable assigned once by a const
+    std::optional<int64_t> GetConstant(OperandBase *op) const;
+
+    bool IsAssignedOnce(OperandBase *op) const;
+
+    std::optional<Accesses> Collect(InstructionBase *alloc) const;
+
+    void Promote(const Accesses &accesses);
+};
+} // namespace sc
@@ -21,6 +21,8 @@ class SSATransformer final : public Transformer {
 
     void Transform() override { RewriteInSSAForm(); }
 
+    bool PreservesCFG() const override { return true; }
+
   private:
     DominatorAnalyzer dom;
     GlobalsAnalyzer globals;
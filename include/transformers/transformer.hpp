@@ -12,11 +12,19 @@ template <typename T>
 concept Transformers =
     std::is_base_of_v<Transformer, T> && !std::is_same_v<Transformer, T>;
 
+template <Transformers T> void ApplyTransformation(Function *func) {
+    T t(func);
+    t.Transform();
+    // Cached analyses only describe the CFG
+    if (!t.PreservesCFG()) {
+        func->InvalidateAnalyses();
+    }
+}
+
 template <Transformers T>
 std::unique_ptr<Program> ApplyTransformation(std::unique_ptr<Program> program) {
     for (auto &f : *program) {
-        T t(f.get());
-        t.Transform();
+        ApplyTransformation<T>(f.get());
     }
     return program;
 }
@@ -26,6 +34,10 @@ class Transformer {
     virtual ~Transformer() = default;
     virtual void Transform() = 0;
 
+    // Transformers that neither add, remove nor reconnect blocks
+    // keep the analyses cached on the function.
+    virtual bool PreservesCFG() const { return false; }
+
   protected:
     Function *func;
 
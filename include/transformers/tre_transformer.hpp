@@ -0,0 +1,35 @@
+#pragma once
+
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <memory>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Tail recursion elimination before SSA construction. A call of the
+ * function to itself whose value is returned right away becomes copies of
+ * the arguments into the parameters and a jump back to the start of the
+ * function, see Cooper and Torczon Ch 10.4.1. SSA construction then
+ * turns the parameters into get/set pairs at the new loop header.
+ *
+ * The entry block keeps the arguments and jumps to the header holding
+ * the rest of the entry, so the loop doesn't read the arguments again.
+ */
+class TRETransformer final : public Transformer {
+  public:
+    TRETransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+  private:
+    size_t count = 0;
+
+    bool IsTailCall(CallInstruction *call) const;
+
+    Block *SplitEntry();
+
+    void Eliminate(CallInstruction *call, Block *header);
+};
+} // namespace sc
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "analyzers/loop_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+/*
+ * Unrolls innermost counted loops before SSA construction. A counted loop
+ * is left from a single block, either the header (while loop) or the
+ * latch (do-while loop), along the false edge of a comparison of the
+ * induction variable with a loop-invariant bound, and the induction
+ * variable is stepped by a constant once per iteration.
+ *
+ * Loops with a small constant trip count are unrolled completely. The
+ * other counted loops are unrolled by the configured factor: a new header
+ * checks that factor iterations remain and runs the unrolled copies of the
+ * body, the original loop is left in place to run the remaining
+ * iterations. CFTransformer merges the copies once the pass is done.
+ */
+class UnrollTransformer final : public Transformer {
+  public:
+    UnrollTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+    // Number of copies of the body in a partially unrolled loop, 1
+    // disables partial unrolling
+    static void SetFactor(size_t _factor) { factor = _factor; }
+
+    static size_t GetFactor() { return factor; }
+
+  private:
+    struct CountedLoop {
+        Loop *loop;
+        bool bottom_tested; // left from the latch
+        Block *entry;       // first block of an iteration
+        Block *exit;        // successor of the exiting block outside the loop
+        InstructionBase *cmp;
+        OperandBase *iv;
+        ValType::INT step;
+        ValType::INT offset; // added to the iv of the iteration before cmp
+        std::vector<Block *> body; // blocks cloned for an iteration
+        size_t size;
+        std::optional<size_t> trip_count;
+    };
+
+    static size_t factor;
+
+    std::optional<CountedLoop> GetCountedLoop(Loop *loop);
+
+    std::optional<ValType::INT> GetEntryConstant(Loop *loop,
+                                                 OperandBase *op) const;
+
+    size_t CountDefs(Loop *loop, OperandBase *op) const;
+
+    void FullUnroll(CountedLoop &cl);
+
+    void PartialUnroll(CountedLoop &cl);
+
+    void RepeatTest(
+        const CountedLoop &cl,
+        const std::vector<std::unordered_map<Block *, Block *>> &copies);
+};
+} // namespace sc
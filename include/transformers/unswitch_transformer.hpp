@@ -0,0 +1,42 @@
+#pragma once
+
+#include "analyzers/dominator_analyzer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+#include <vector>
+
+namespace sc {
+
+/*
+ * Loop unswitching before SSA construction. A loop containing a branch on
+ * a loop-invariant condition is cloned, the preheader tests the condition
+ * once and enters the version where the branch always goes the same way.
+ * CFTransformer removes the side that became unreachable in each version.
+ * A branch is left alone when either version would never leave the loop.
+ *
+ * A branch is unswitched in the outermost loop where it's invariant, and a
+ * loop is unswitched at most once per run. Loops larger than a fixed size
+ * and clones beyond a budget per function are skipped, so nested loops
+ * can't blow up the code.
+ */
+class UnswitchTransformer final : public Transformer {
+  public:
+    UnswitchTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+  private:
+    DominatorAnalyzer *dom = nullptr;
+
+    BranchInstruction *FindInvariantBranch(Loop *loop) const;
+
+    bool IsDefinedAt(OperandBase *op, Block *block) const;
+
+    // Whether the loop still has a way out when the branch ending block
+    // always goes to taken
+    bool CanExit(Loop *loop, Block *block, Block *taken) const;
+
+    void Unswitch(Loop *loop, BranchInstruction *br, size_t id);
+};
+} // namespace sc
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "analyzers/range_analyzer.hpp"
+#include "instruction.hpp"
+#include "transformer.hpp"
+
+namespace sc {
+
+/*
+ * Value range propagation on SSA form. The ints and bools whose range
+ * is a single value become consts, which folds the comparisons decided
+ * by the ranges like the exit test of an induction variable against a
+ * bound it can't reach. A br whose condition is known in its block, or
+ * one of whose edges is never taken, becomes a jmp and the blocks that
+ * are never executed are removed along with the sets feeding them.
+ *
+ * Only the pure computations are folded, calls and loads stay even when
+ * their value is known.
+ */
+class VRPTransformer final : public Transformer {
+  public:
+    VRPTransformer(Function *_f) : Transformer(_f) {}
+
+    void Transform() override;
+
+  private:
+    RangeAnalyzer ra{func};
+    size_t folded = 0;
+    size_t branches = 0;
+    size_t blocks = 0;
+
+    void Fold(Block *block);
+    void FoldBranch(Block *block);
+    void RemoveUnreachable();
+};
+} // namespace sc
@@ -0,0 +1,245 @@
+#include "analyzers/alias_analyzer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include <algorithm>
+#include <ranges>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// AliasAnalyzer begin
+void AliasAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    origins.clear();
+    escaped.clear();
+    returned.clear();
+
+    FindOrigins();
+    FindEscaped();
+}
+
+void AliasAnalyzer::FindOrigins() {
+    // The sets only grow, gets carrying pointers around loops are
+    // visited until nothing changes
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto *block : func->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                if (!instr->HasDest() ||
+                    instr->GetDest()->GetType() != DataType::PTR) {
+                    continue;
+                }
+
+                auto &set = origins[instr->GetDest()];
+                auto size = set.size();
+                switch (instr->GetOpcode()) {
+                case Opcode::ID:
+                case Opcode::PTRADD: {
+                    auto it = origins.find(instr->GetOperand(0));
+                    if (it != origins.end()) {
+                        set.insert(it->second.begin(), it->second.end());
+                    }
+                    break;
+                }
+                case Opcode::GET:
+                    for (auto *seti :
+                         static_cast<GetInstruction *>(instr)->GetSetPairs()) {
+                        auto it = origins.find(seti->GetOperand(0));
+                        if (it != origins.end()) {
+                            set.insert(it->second.begin(), it->second.end());
+                        }
+                    }
+                    break;
+                case Opcode::UNDEF:
+                    break;
+                default:
+                    // alloc, getarg, load and call
+                    set.insert(instr);
+                    break;
+                }
+                changed |= set.size() != size;
+            }
+        }
+    }
+}
+
+void AliasAnalyzer::FindEscaped() {
+    auto escape = [this](OperandBase *p,
+                         std::unordered_set<InstructionBase *> &allocs) {
+        for (auto *origin : GetOrigins(p)) {
+            if (origin->GetOpcode() == Opcode::ALLOC) {
+                allocs.insert(origin);
+            }
+        }
+    };
+
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::STORE) {
+                escape(instr->GetOperand(1), escaped);
+            } else if (instr->GetOpcode() == Opcode::CALL) {
+                for (auto *op : instr->GetOperands()) {
+                    escape(op, escaped);
+                }
+            } else if (instr->GetOpcode() == Opcode::RET &&
+                       instr->GetOperandSize()) {
+                escape(instr->GetOperand(0), returned);
+            }
+        }
+    }
+}
+
+AliasResult AliasAnalyzer::Alias(OperandBase *p, OperandBase *q) const {
+    auto lp = GetLocation(p);
+    auto lq = GetLocation(q);
+    if (lp.root == lq.root) {
+        if (!lp.offset || !lq.offset) {
+            return AliasResult::MAY_ALIAS;
+        }
+        return *lp.offset == *lq.offset ? AliasResult::MUST_ALIAS
+                                        : AliasResult::NO_ALIAS;
+    }
+    return MayShareObject(p, q) ? AliasResult::MAY_ALIAS
+                                : AliasResult::NO_ALIAS;
+}
+
+bool AliasAnalyzer::MayModify(InstructionBase *instr, OperandBase *p) const {
+    switch (instr->GetOpcode()) {
+    case Opcode::STORE:
+        return MayAlias(instr->GetOperand(0), p);
+    case Opcode::FREE:
+        return MayShareObject(instr->GetOperand(0), p);
+    case Opcode::CALL: {
+        auto *summary = func->GetCalleeSummary(
+            static_cast<CallInstruction *>(instr)->GetFuncName());
+        if (summary && !summary->Has(FunctionSummary::WRITES) &&
+            !summary->Has(FunctionSummary::FREES)) {
+            return false;
+        }
+        return MayBeVisible(p);
+    }
+    default:
+        return false;
+    }
+}
+
+bool AliasAnalyzer::MayRead(InstructionBase *instr, OperandBase *p) const {
+    switch (instr->GetOpcode()) {
+    case Opcode::LOAD:
+        return MayAlias(instr->GetOperand(0), p);
+    case Opcode::CALL: {
+        auto *summary = func->GetCalleeSummary(
+            static_cast<CallInstruction *>(instr)->GetFuncName());
+        if (summary && !summary->Has(FunctionSummary::READS)) {
+            return false;
+        }
+        return MayBeVisible(p);
+    }
+    case Opcode::RET:
+        return MayBeVisible(p) ||
+               std::ranges::any_of(GetOrigins(p), [this](auto *origin) {
+                   return returned.contains(origin);
+               });
+    default:
+        return false;
+    }
+}
+
+MemoryLocation AliasAnalyzer::GetLocation(OperandBase *p) {
+    MemoryLocation loc{p, 0};
+    while (auto *def = loc.root->GetDef()) {
+        if (def->GetOpcode() == Opcode::ID) {
+            loc.root = def->GetOperand(0);
+        } else if (def->GetOpcode() == Opcode::PTRADD) {
+            auto *index = def->GetOperand(1)->GetDef();
+            if (loc.offset && index && index->GetOpcode() == Opcode::CONST) {
+                *loc.offset +=
+                    static_cast<IntOperand *>(index->GetOperand(0))->GetValue();
+            } else {
+                loc.offset = std::nullopt;
+            }
+            loc.root = def->GetOperand(0);
+        } else {
+            break;
+        }
+    }
+    return loc;
+}
+
+const std::set<InstructionBase *> &
+AliasAnalyzer::GetOrigins(OperandBase *p) const {
+    static const std::set<InstructionBase *> none;
+    auto it = origins.find(p);
+    return it == origins.end() ? none : it->second;
+}
+
+bool AliasAnalyzer::MayShareObject(OperandBase *p, OperandBase *q) const {
+    auto &a = GetOrigins(p);
+    auto &b = GetOrigins(q);
+    return std::ranges::any_of(a, [this, &b](InstructionBase *x) {
+        return std::ranges::any_of(
+            b, [this, x](InstructionBase *y) { return MayBeSameObject(x, y); });
+    });
+}
+
+bool AliasAnalyzer::MayBeSameObject(InstructionBase *a,
+                                    InstructionBase *b) const {
+    if (a == b) {
+        return true;
+    }
+    auto is_alloc = [](InstructionBase *instr) {
+        return instr->GetOpcode() == Opcode::ALLOC;
+    };
+    if (is_alloc(a) && is_alloc(b)) {
+        return false;
+    }
+    if (is_alloc(b)) {
+        std::swap(a, b);
+    }
+    if (is_alloc(a)) {
+        // Arguments point to objects older than the allocation
+        return b->GetOpcode() != Opcode::GETARG && escaped.contains(a);
+    }
+    return true;
+}
+
+bool AliasAnalyzer::MayBeVisible(OperandBase *p) const {
+    return std::ranges::any_of(GetOrigins(p), [this](InstructionBase *origin) {
+        return origin->GetOpcode() != Opcode::ALLOC || escaped.contains(origin);
+    });
+}
+
+void AliasAnalyzer::DumpOrigins(std::ostream &out) const {
+    out << "Pointer Origins: " << func->GetName() << "\n";
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (!instr->HasDest() || !origins.contains(instr->GetDest())) {
+                continue;
+            }
+
+            auto loc = GetLocation(instr->GetDest());
+            out << "  " << instr->GetDest()->GetName() << ": "
+                << loc.root->GetName() << " + ";
+            if (loc.offset) {
+                out << *loc.offset;
+            } else {
+                out << "?";
+            }
+            out << " from";
+            for (auto *origin : GetOrigins(instr->GetDest())) {
+                out << " " << origin->GetDest()->GetName();
+                if (escaped.contains(origin)) {
+                    out << " (escaped)";
+                }
+            }
+            out << "\n";
+        }
+    }
+}
+// AliasAnalyzer end
+} // namespace sc
@@ -0,0 +1,125 @@
+#include "analyzers/call_graph_analyzer.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <functional>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// CallGraphAnalyzer begin
+void CallGraphAnalyzer::Analyze() {
+    functions.clear();
+    callees.clear();
+    calls.clear();
+
+    for (auto &f : *program) {
+        functions[f->GetName()] = f.get();
+    }
+
+    for (auto &f : *program) {
+        auto &fcallees = callees[f.get()];
+        auto &fcalls = calls[f.get()];
+        for (auto *block : f->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                if (instr->GetOpcode() != Opcode::CALL) {
+                    continue;
+                }
+
+                auto *call = static_cast<CallInstruction *>(instr);
+                fcalls.push_back(call);
+                auto *callee = GetFunction(call->GetFuncName());
+                if (callee && std::ranges::find(fcallees, callee) ==
+                                  fcallees.end()) {
+                    fcallees.push_back(callee);
+                }
+            }
+        }
+    }
+
+    FindSCCs();
+
+#ifdef PRINT_DEBUG
+    DumpCallGraph(std::cerr);
+#endif
+}
+
+void CallGraphAnalyzer::FindSCCs() {
+    // Tarjan's algorithm, a component is completed after the components
+    // reachable from it.
+    sccs.clear();
+    scc_index.clear();
+    std::unordered_map<Function *, size_t> num;
+    std::unordered_map<Function *, size_t> low;
+    std::vector<Function *> stack;
+    std::unordered_map<Function *, bool> on_stack;
+    size_t next = 1;
+
+    std::function<void(Function *)> visit = [&](Function *f) {
+        num[f] = low[f] = next++;
+        stack.push_back(f);
+        on_stack[f] = true;
+
+        for (auto *callee : callees[f]) {
+            if (!num.contains(callee)) {
+                visit(callee);
+                low[f] = std::min(low[f], low[callee]);
+            } else if (on_stack[callee]) {
+                low[f] = std::min(low[f], num[callee]);
+            }
+        }
+
+        if (low[f] != num[f]) {
+            return;
+        }
+
+        auto &scc = sccs.emplace_back();
+        Function *g;
+        do {
+            g = stack.back();
+            stack.pop_back();
+            on_stack[g] = false;
+            scc_index[g] = sccs.size() - 1;
+            scc.push_back(g);
+        } while (g != f);
+    };
+
+    for (auto &f : *program) {
+        if (!num.contains(f.get())) {
+            visit(f.get());
+        }
+    }
+}
+
+bool CallGraphAnalyzer::IsRecursive(Function *func) const {
+    return sccs[GetSCCIndex(func)].size() > 1 ||
+           std::ranges::find(GetCallees(func), func) != GetCallees(func).end();
+}
+
+std::vector<Function *> CallGraphAnalyzer::GetBottomUpOrder() const {
+    std::vector<Function *> order;
+    for (auto &scc : sccs) {
+        order.insert(order.end(), scc.begin(), scc.end());
+    }
+    return order;
+}
+
+std::vector<Function *> CallGraphAnalyzer::GetTopDownOrder() const {
+    auto order = GetBottomUpOrder();
+    std::ranges::reverse(order);
+    return order;
+}
+
+void CallGraphAnalyzer::DumpCallGraph(std::ostream &out) const {
+    out << "Call Graph:\n";
+    for (auto &f : *program) {
+        out << "  " << f->GetName() << " [scc " << scc_index.at(f.get())
+            << (IsRecursive(f.get()) ? ", recursive" : "") << "]:";
+        for (auto *callee : callees.at(f.get())) {
+            out << " " << callee->GetName();
+        }
+        out << "\n";
+    }
+}
+// CallGraphAnalyzer end
+} // namespace sc
@@ -34,7 +34,7 @@ const std::vector<Block *> GetReversePostOrder(CFG *cfg) {
     return post_order;
 }
 
-static void BuildCFGImpl(Function *func) {
+void BuildCFG(Function *func) {
     auto add_nodes = [](Block *pred, Block *succ) {
         pred->AddSuccessor(succ);
         succ->AddPredecessor(pred);
@@ -65,7 +65,7 @@ std::unique_ptr<Program> BuildCFG(std::unique_ptr<Program> program) {
     // each block in a function. Once the sucessors/predecessors
     // are built use the CFGContainers to perform operations on them.
     for (auto &f : *program) {
-        BuildCFGImpl(f.get());
+        BuildCFG(f.get());
     }
     return program;
 }
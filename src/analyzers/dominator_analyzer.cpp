@@ -4,6 +4,7 @@
 namespace sc {
 // DominatorAnalyzer begin
 void DominatorAnalyzer::ComputeDominance() {
+    dom.clear();
     for (auto _ : std::views::iota(0ul, func->GetBlockSize())) {
         dom.emplace_back(func->GetBlockSize(), true);
     }
@@ -51,6 +52,11 @@ void DominatorAnalyzer::ComputeImmediateDominators() {
         sdom.Reset(i);
         auto dominators = sdom.GetBlocks();
         for (auto k : dominators) {
+            // The set of a block the root doesn't reach is full, including
+            // the bits past the last block
+            if (k >= func->GetBlockSize()) {
+                break;
+            }
             if (sdom == dom[k]) {
                 idom[i] = func->GetBlock(k);
                 break;
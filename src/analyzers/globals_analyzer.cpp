@@ -24,7 +24,7 @@ void GlobalsAnalyzer::ComputeGlobalNames() {
 
 void GlobalsAnalyzer::DumpGlobals(std::ostream &out) const {
     out << "Globals: " << func->GetName() << "\n";
-    for (auto *op : globals) {
+    for (auto *op : order) {
         out << "  " << op->GetName() << "\n";
     }
 }
@@ -44,14 +44,18 @@ void GlobalsAnalyzer::DumpBlocks(std::ostream &out) const {
 void GlobalsAnalyzer::Process(std::unordered_set<OperandBase *> &var_kill,
                               InstructionBase *instr, Block *block) {
     for (auto *op : instr->GetOperands()) {
-        if (!var_kill.contains(op)) {
-            globals.insert(op);
+        if (!var_kill.contains(op) && globals.insert(op).second) {
+            order.push_back(op);
         }
     }
 
     if (instr->HasDest()) {
         var_kill.insert(instr->GetDest());
-        blocks[instr->GetDest()].insert(block);
+        // Blocks are processed one after another
+        auto &def_blocks = blocks[instr->GetDest()];
+        if (def_blocks.empty() || def_blocks.back() != block) {
+            def_blocks.push_back(block);
+        }
     }
 }
 // GlobalsAnalyzer end
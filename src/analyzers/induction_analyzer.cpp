@@ -0,0 +1,262 @@
+#include "analyzers/induction_analyzer.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <unordered_set>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// InductionAnalyzer begin
+void InductionAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    ivs.clear();
+    derived.clear();
+    iv_index.clear();
+
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    for (auto *loop : loops->GetLoopsInnermostFirst()) {
+        FindInductionVariables(loop);
+        FindDerivedInductionVariables(loop);
+    }
+}
+
+bool InductionAnalyzer::IsRegionConstant(Loop *loop, OperandBase *op) {
+    auto *def = op->GetDef();
+    return !def || def->GetOpcode() == Opcode::CONST ||
+           !loop->Contains(def->GetBlock());
+}
+
+void InductionAnalyzer::FindInductionVariables(Loop *loop) {
+    // Nodes of the SSA graph that may be part of an induction variable,
+    // edges go from an instruction to the definitions of its operands.
+    std::vector<InstructionBase *> nodes;
+    for (auto *block : loop->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            switch (instr->GetOpcode()) {
+            case Opcode::GET:
+            case Opcode::ID:
+            case Opcode::ADD:
+            case Opcode::SUB:
+            case Opcode::PTRADD:
+                nodes.push_back(instr);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    std::unordered_map<InstructionBase *, size_t> position;
+    for (auto i : std::views::iota(0ul, nodes.size())) {
+        position[nodes[i]] = i;
+    }
+
+    auto operands = [](InstructionBase *instr) {
+        std::vector<OperandBase *> ops;
+        if (instr->GetOpcode() == Opcode::GET) {
+            for (auto *seti : static_cast<GetInstruction *>(instr)->GetSetPairs()) {
+                ops.push_back(seti->GetOperand(0));
+            }
+        } else {
+            auto span = instr->GetOperands();
+            ops.assign(span.begin(), span.end());
+        }
+        return ops;
+    };
+
+    // Tarjan's algorithm
+    std::vector<size_t> num(nodes.size(), 0);
+    std::vector<size_t> low(nodes.size(), 0);
+    std::vector<bool> on_stack(nodes.size(), false);
+    std::vector<size_t> stack;
+    size_t next = 1;
+
+    std::function<void(size_t)> visit = [&](size_t n) {
+        num[n] = low[n] = next++;
+        stack.push_back(n);
+        on_stack[n] = true;
+
+        for (auto *op : operands(nodes[n])) {
+            auto *def = op->GetDef();
+            auto it = def ? position.find(def) : position.end();
+            if (it == position.end()) {
+                continue;
+            }
+
+            auto m = it->second;
+            if (!num[m]) {
+                visit(m);
+                low[n] = std::min(low[n], low[m]);
+            } else if (on_stack[m]) {
+                low[n] = std::min(low[n], num[m]);
+            }
+        }
+
+        if (low[n] != num[n]) {
+            return;
+        }
+
+        std::vector<InstructionBase *> scc;
+        size_t m;
+        do {
+            m = stack.back();
+            stack.pop_back();
+            on_stack[m] = false;
+            scc.push_back(nodes[m]);
+        } while (m != n);
+
+        if (!IsInductionVariable(loop, scc)) {
+            return;
+        }
+
+        std::ranges::sort(scc, [&position](auto *a, auto *b) {
+            return position[a] < position[b];
+        });
+        ivs[loop].push_back({loop, std::move(scc)});
+    };
+
+    for (auto i : std::views::iota(0ul, nodes.size())) {
+        if (!num[i]) {
+            visit(i);
+        }
+    }
+
+    // Same order as the instructions
+    std::ranges::sort(ivs[loop], [&position](auto &a, auto &b) {
+        return position[a.members[0]] < position[b.members[0]];
+    });
+    for (auto i : std::views::iota(0ul, ivs[loop].size())) {
+        for (auto *instr : ivs[loop][i].members) {
+            iv_index[loop][instr->GetDest()] = i;
+        }
+    }
+}
+
+bool InductionAnalyzer::IsInductionVariable(
+    Loop *loop, const std::vector<InstructionBase *> &scc) const {
+    if (scc.size() < 2) {
+        return false;
+    }
+
+    std::unordered_set<OperandBase *> values;
+    bool header = false;
+    for (auto *instr : scc) {
+        values.insert(instr->GetDest());
+        header |= instr->GetOpcode() == Opcode::GET &&
+                  instr->GetBlock() == loop->GetHeader();
+    }
+    if (!header) {
+        return false;
+    }
+
+    auto is_rc = [loop](OperandBase *op) { return IsRegionConstant(loop, op); };
+
+    return std::ranges::all_of(scc, [&](InstructionBase *instr) {
+        switch (instr->GetOpcode()) {
+        case Opcode::GET:
+            return std::ranges::all_of(
+                static_cast<GetInstruction *>(instr)->GetSetPairs(),
+                [&](SetInstruction *seti) {
+                    auto *op = seti->GetOperand(0);
+                    return values.contains(op) || is_rc(op);
+                });
+        case Opcode::ID:
+            return values.contains(instr->GetOperand(0));
+        case Opcode::ADD: {
+            // iv + iv doubles instead of stepping
+            auto *lop = instr->GetOperand(0);
+            auto *rop = instr->GetOperand(1);
+            return (values.contains(lop) && is_rc(rop)) ||
+                   (is_rc(lop) && values.contains(rop));
+        }
+        default:
+            // sub and ptradd step the first operand
+            return values.contains(instr->GetOperand(0)) &&
+                   is_rc(instr->GetOperand(1));
+        }
+    });
+}
+
+void InductionAnalyzer::FindDerivedInductionVariables(Loop *loop) {
+    auto &basic = iv_index[loop];
+    std::unordered_set<OperandBase *> values;
+    auto is_iv = [&basic, &values](OperandBase *op) {
+        return basic.contains(op) || values.contains(op);
+    };
+    auto is_rc = [loop](OperandBase *op) { return IsRegionConstant(loop, op); };
+
+    // A derived induction variable may be computed from another one
+    // found later in the loop.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto *block : loop->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                auto opcode = instr->GetOpcode();
+                if ((opcode != Opcode::ADD && opcode != Opcode::SUB &&
+                     opcode != Opcode::MUL && opcode != Opcode::PTRADD) ||
+                    is_iv(instr->GetDest())) {
+                    continue;
+                }
+
+                auto *lop = instr->GetOperand(0);
+                auto *rop = instr->GetOperand(1);
+                OperandBase *iv = nullptr;
+                OperandBase *rc = nullptr;
+                if (opcode == Opcode::PTRADD) {
+                    // The pointer stays the same, the offset moves
+                    if (is_rc(lop) && is_iv(rop)) {
+                        iv = rop, rc = lop;
+                    }
+                } else if (is_iv(lop) && is_rc(rop)) {
+                    iv = lop, rc = rop;
+                } else if (opcode != Opcode::SUB && is_rc(lop) && is_iv(rop)) {
+                    iv = rop, rc = lop;
+                }
+
+                if (iv) {
+                    derived[loop].push_back({instr, iv, rc});
+                    values.insert(instr->GetDest());
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+const InductionVariable *
+InductionAnalyzer::GetInductionVariable(Loop *loop, OperandBase *op) const {
+    auto it = iv_index.find(loop);
+    if (it == iv_index.end()) {
+        return nullptr;
+    }
+    auto iit = it->second.find(op);
+    return iit == it->second.end() ? nullptr
+                                   : &ivs.at(loop)[iit->second];
+}
+
+void InductionAnalyzer::DumpInductionVariables(std::ostream &out) {
+    out << "Induction Variables: " << func->GetName() << "\n";
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    for (auto *loop : loops->GetLoopsInnermostFirst()) {
+        out << "  loop: " << loop->GetHeader()->GetName() << "\n";
+        for (auto &iv : ivs[loop]) {
+            out << "    basic:";
+            for (auto *instr : iv.members) {
+                out << " " << instr->GetDest()->GetName();
+            }
+            out << "\n";
+        }
+        for (auto &div : derived[loop]) {
+            div.instr->Dump(out << "    derived: ");
+        }
+    }
+}
+// InductionAnalyzer end
+} // namespace sc
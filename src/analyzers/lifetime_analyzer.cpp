@@ -0,0 +1,116 @@
+#include "analyzers/lifetime_analyzer.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// LifetimeAnalyzer begin
+void LifetimeAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    frees.clear();
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::ALLOC) {
+                frees[instr];
+            } else if (instr->GetOpcode() == Opcode::FREE) {
+                auto *ptr = instr->GetOperand(0);
+                while (ptr->GetDef() &&
+                       ptr->GetDef()->GetOpcode() == Opcode::ID) {
+                    ptr = ptr->GetDef()->GetOperand(0);
+                }
+                auto *def = ptr->GetDef();
+                if (def && def->GetOpcode() == Opcode::ALLOC) {
+                    frees[def].push_back(instr);
+                }
+            }
+        }
+    }
+}
+
+bool LifetimeAnalyzer::IsFreed(InstructionBase *alloc, Loop *loop) {
+    auto &fs = frees[alloc];
+    if (fs.empty()) {
+        return false;
+    }
+
+    // Whether the path entering block at idx frees the object before
+    // allocating it again or leaving block
+    auto frees_in = [&fs, alloc](Block *block, size_t idx) {
+        for (auto i = idx; i < block->GetInstructionSize(); ++i) {
+            auto *instr = block->GetInstruction(i);
+            if (instr == alloc) {
+                return false;
+            }
+            if (std::ranges::find(fs, instr) != fs.end()) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto *start = alloc->GetBlock();
+    if (frees_in(start, alloc->GetIndex() + 1)) {
+        return true;
+    }
+
+    // Blocks reached without freeing the object
+    std::vector<Block *> worklist = {start};
+    std::unordered_set<Block *> visited = {start};
+    while (!worklist.empty()) {
+        auto *block = worklist.back();
+        worklist.pop_back();
+        if (block->GetSuccessors().empty()) {
+            // Returns
+            return false;
+        }
+
+        for (auto *succ : block->GetSuccessors()) {
+            if (loop && (!loop->Contains(succ) || succ == loop->GetHeader())) {
+                return false;
+            }
+            if (succ == start) {
+                // Allocates again, or reaches the start of the path
+                if (!frees_in(succ, 0)) {
+                    return false;
+                }
+                continue;
+            }
+            if (visited.insert(succ).second && !frees_in(succ, 0)) {
+                worklist.push_back(succ);
+            }
+        }
+    }
+    return true;
+}
+
+void LifetimeAnalyzer::DumpLifetimes(std::ostream &out) {
+    out << "Lifetimes: " << func->GetName() << "\n";
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() != Opcode::ALLOC) {
+                continue;
+            }
+
+            out << "  " << instr->GetDest()->GetName() << ":";
+            if (IsFreedInFunction(instr)) {
+                out << " function";
+            }
+            for (auto *loop = loops->GetLoopFor(block); loop;
+                 loop = loop->GetParent()) {
+                if (IsFreedInIteration(instr, loop)) {
+                    out << " " << loop->GetHeader()->GetName();
+                }
+            }
+            out << "\n";
+        }
+    }
+}
+// LifetimeAnalyzer end
+} // namespace sc
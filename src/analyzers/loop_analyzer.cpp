@@ -0,0 +1,282 @@
+#include "analyzers/loop_analyzer.hpp"
+#include "analyzers/cfg.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "instruction.hpp"
+#include <algorithm>
+#include <ranges>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// Loop begin
+void Loop::Dump(std::ostream &out) const {
+    auto indent = std::string(2 * GetDepth(), ' ');
+    auto dump_blocks = [&out](const char *name,
+                              const std::vector<Block *> &blks) {
+        out << name << ":";
+        for (auto *blk : blks) {
+            out << " " << blk->GetName();
+        }
+        out << "\n";
+    };
+
+    out << indent << "loop: " << header->GetName() << " depth: " << GetDepth()
+        << "\n";
+    out << indent << "  preheader: "
+        << (preheader ? preheader->GetName() : std::string()) << "\n";
+    dump_blocks((indent + "  latches").c_str(), latches);
+    dump_blocks((indent + "  exits").c_str(), exits);
+    dump_blocks((indent + "  blocks").c_str(), blocks);
+
+    for (auto *loop : subloops) {
+        loop->Dump(out);
+    }
+}
+// Loop end
+
+// LoopAnalyzer begin
+void LoopAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    FindLoops();
+    BuildForest();
+
+    auto size = func->GetBlockSize();
+    for (auto &loop : loops) {
+        InsertPreheader(loop.get());
+    }
+
+    // Exits are computed last since a preheader inserted for one loop
+    // may be the exit of another.
+    for (auto &loop : loops) {
+        ComputeExits(loop.get());
+        std::ranges::sort(loop->blocks, [&loop](Block *a, Block *b) {
+            if (a == loop->header || b == loop->header) {
+                return a == loop->header && b != loop->header;
+            }
+            return a->GetIndex() < b->GetIndex();
+        });
+    }
+
+    if (size != func->GetBlockSize()) {
+        func->InvalidateAnalysis<DominatorAnalyzer>();
+    }
+}
+
+void LoopAnalyzer::FindLoops() {
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+    auto cfg = ForwardCFG(func);
+    auto rpo = GetReversePostOrder(&cfg);
+    std::unordered_set<Block *> reachable(rpo.begin(), rpo.end());
+
+    // An edge whose target dominates its source is a back edge
+    std::unordered_map<Block *, Loop *> headers;
+    for (auto *block : rpo) {
+        for (auto *succ : block->GetSuccessors()) {
+            if (!dom->Dominates(succ, block)) {
+                continue;
+            }
+
+            auto *&loop = headers[succ];
+            if (!loop) {
+                loops.push_back(std::make_unique<Loop>(succ));
+                loop = loops.back().get();
+            }
+            if (std::ranges::find(loop->latches, block) ==
+                loop->latches.end()) {
+                loop->latches.push_back(block);
+            }
+        }
+    }
+
+    // The body is everything that reaches a latch without going
+    // through the header.
+    for (auto &loop : loops) {
+        loop->members.insert(loop->header);
+        loop->blocks.push_back(loop->header);
+
+        std::vector<Block *> worklist;
+        for (auto *latch : loop->latches) {
+            if (loop->members.insert(latch).second) {
+                loop->blocks.push_back(latch);
+                worklist.push_back(latch);
+            }
+        }
+
+        while (!worklist.empty()) {
+            auto *block = worklist.back();
+            worklist.pop_back();
+            for (auto *pred : block->GetPredecessors()) {
+                if (reachable.contains(pred) &&
+                    loop->members.insert(pred).second) {
+                    loop->blocks.push_back(pred);
+                    worklist.push_back(pred);
+                }
+            }
+        }
+    }
+}
+
+void LoopAnalyzer::BuildForest() {
+    // Natural loops with different headers are either disjoint or
+    // nested, so the parent of a loop is the smallest larger loop
+    // containing its header.
+    std::ranges::stable_sort(loops, [](auto &a, auto &b) {
+        return a->blocks.size() > b->blocks.size();
+    });
+
+    for (auto i : std::views::iota(0ul, loops.size())) {
+        auto *loop = loops[i].get();
+        for (auto j = i; j-- > 0;) {
+            if (loops[j]->Contains(loop->header)) {
+                loop->parent = loops[j].get();
+                break;
+            }
+        }
+
+        if (loop->parent) {
+            loop->parent->subloops.push_back(loop);
+        } else {
+            top_level.push_back(loop);
+        }
+
+        // Smaller loops come later and override the outer ones
+        for (auto *block : loop->blocks) {
+            innermost[block] = loop;
+        }
+    }
+
+    auto by_header = [](Loop *a, Loop *b) {
+        return a->header->GetIndex() < b->header->GetIndex();
+    };
+    std::ranges::sort(top_level, by_header);
+    for (auto &loop : loops) {
+        std::ranges::sort(loop->subloops, by_header);
+    }
+}
+
+void LoopAnalyzer::InsertPreheader(Loop *loop) {
+    auto *header = loop->header;
+    if (header == func->GetBlock(0)) {
+        return;
+    }
+
+    std::vector<Block *> outside;
+    for (auto *pred : header->GetPredecessors()) {
+        if (!loop->Contains(pred) &&
+            std::ranges::find(outside, pred) == outside.end()) {
+            outside.push_back(pred);
+        }
+    }
+
+    if (outside.size() == 1 && outside[0]->GetSuccessorSize() == 1) {
+        loop->preheader = outside[0];
+        return;
+    }
+
+    // Preheaders are named after their header
+    auto name = "__sc_ph_" + header->GetName();
+    for (size_t i = 1; std::ranges::any_of(
+             func->GetBlocks(), [&name](Block *b) { return b->GetName() == name; });
+         ++i) {
+        name = "__sc_ph" + std::to_string(i) + "_" + header->GetName();
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__ << " Inserting " << name << "\n";
+#endif
+
+    auto block = std::make_unique<Block>(name);
+    auto label = std::make_unique<LabelOperand>(name);
+    label->SetBlock(block.get());
+    block->SetLabel(std::move(label));
+    auto *preheader = block.get();
+
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(header->GetLabel());
+    preheader->AddInstruction(std::move(jmp_instr));
+
+    // Redirect the edges entering the loop to the preheader
+    for (auto *pred : outside) {
+        auto *instr = LAST_INSTR(pred);
+        if (instr->GetOpcode() == Opcode::JMP) {
+            static_cast<JmpInstruction *>(instr)->SetJmpDest(
+                preheader->GetLabel());
+        } else {
+            assert(instr->GetOpcode() == Opcode::BR);
+            auto *br = static_cast<BranchInstruction *>(instr);
+            if (br->GetTrueDest()->GetBlock() == header) {
+                br->SetTrueDest(preheader->GetLabel());
+            }
+            if (br->GetFalseDest()->GetBlock() == header) {
+                br->SetFalseDest(preheader->GetLabel());
+            }
+        }
+
+        for (auto i : std::views::iota(0ul, pred->GetSuccessorSize())) {
+            if (pred->GetSuccessor(i) == header) {
+                pred->AddSuccessor(preheader, i);
+            }
+        }
+
+        auto preds = header->GetPredecessors();
+        while (std::ranges::find(preds, pred) != preds.end()) {
+            header->RemovePredecessor(pred);
+            preds = header->GetPredecessors();
+        }
+        preheader->AddPredecessor(pred);
+    }
+
+    preheader->AddSuccessor(header);
+    header->AddPredecessor(preheader);
+    func->InsertBlock(std::move(block), header->GetIndex());
+    loop->preheader = preheader;
+
+    // The preheader is part of every loop enclosing this one
+    for (auto *parent = loop->parent; parent; parent = parent->parent) {
+        parent->members.insert(preheader);
+        parent->blocks.push_back(preheader);
+    }
+    if (loop->parent) {
+        innermost[preheader] = loop->parent;
+    }
+}
+
+void LoopAnalyzer::ComputeExits(Loop *loop) {
+    loop->exits.clear();
+    for (auto *block : loop->blocks) {
+        for (auto *succ : block->GetSuccessors()) {
+            if (!loop->Contains(succ) &&
+                std::ranges::find(loop->exits, succ) == loop->exits.end()) {
+                loop->exits.push_back(succ);
+            }
+        }
+    }
+}
+
+std::vector<Loop *> LoopAnalyzer::GetLoopsInnermostFirst() const {
+    std::vector<Loop *> order;
+    auto visit = [&order](auto &self, Loop *loop) -> void {
+        for (auto *sub : loop->GetSubLoops()) {
+            self(self, sub);
+        }
+        order.push_back(loop);
+    };
+
+    for (auto *loop : top_level) {
+        visit(visit, loop);
+    }
+    return order;
+}
+
+void LoopAnalyzer::DumpLoops(std::ostream &out) const {
+    out << "Loops: " << func->GetName() << "\n";
+    for (auto *loop : top_level) {
+        loop->Dump(out);
+    }
+}
+// LoopAnalyzer end
+} // namespace sc
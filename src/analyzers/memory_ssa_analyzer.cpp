@@ -0,0 +1,189 @@
+#include "analyzers/memory_ssa_analyzer.hpp"
+#include "opcodes.hpp"
+#include <format>
+#include <unordered_set>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// MemorySSAAnalyzer begin
+void MemorySSAAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    nodes.clear();
+    accesses.clear();
+    phis.clear();
+
+    auto *first = func->GetBlock(0);
+    entry = NewAccess(MemoryAccess::Kind::ENTRY, first);
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (auto kind = Classify(instr)) {
+                accesses[instr] = NewAccess(*kind, block, instr);
+            }
+        }
+    }
+
+    dom.ComputeDominanceFrontier();
+    PlacePhis();
+    dom.BuildDominatorTree();
+    Rename(first, entry);
+}
+
+std::optional<MemoryAccess::Kind>
+MemorySSAAnalyzer::Classify(InstructionBase *instr) const {
+    switch (instr->GetOpcode()) {
+    case Opcode::LOAD:
+    case Opcode::RET:
+        return MemoryAccess::Kind::USE;
+    case Opcode::STORE:
+    case Opcode::FREE:
+        return MemoryAccess::Kind::DEF;
+    case Opcode::CALL: {
+        auto *summary = func->GetCalleeSummary(
+            static_cast<CallInstruction *>(instr)->GetFuncName());
+        if (!summary || summary->Has(FunctionSummary::WRITES) ||
+            summary->Has(FunctionSummary::FREES)) {
+            return MemoryAccess::Kind::DEF;
+        }
+        if (summary->Has(FunctionSummary::READS)) {
+            return MemoryAccess::Kind::USE;
+        }
+        return std::nullopt;
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+MemoryAccess *MemorySSAAnalyzer::NewAccess(MemoryAccess::Kind kind,
+                                           Block *block,
+                                           InstructionBase *instr) {
+    auto access = std::make_unique<MemoryAccess>();
+    access->kind = kind;
+    access->id = nodes.size();
+    access->block = block;
+    access->instr = instr;
+    nodes.push_back(std::move(access));
+    return nodes.back().get();
+}
+
+void MemorySSAAnalyzer::PlacePhis() {
+    std::vector<Block *> worklist;
+    std::unordered_set<Block *> queued;
+    for (auto &node : nodes) {
+        if (node->kind == MemoryAccess::Kind::DEF &&
+            queued.insert(node->block).second) {
+            worklist.push_back(node->block);
+        }
+    }
+
+    // Iterated dominance frontier of the blocks writing memory
+    while (!worklist.empty()) {
+        auto *block = worklist.back();
+        worklist.pop_back();
+        for (auto *d : dom.GetDominanceFrontier(block)) {
+            if (phis.contains(d)) {
+                continue;
+            }
+            phis[d] = NewAccess(MemoryAccess::Kind::PHI, d);
+            if (queued.insert(d).second) {
+                worklist.push_back(d);
+            }
+        }
+    }
+}
+
+void MemorySSAAnalyzer::Rename(Block *block, MemoryAccess *current) {
+    if (auto *phi = GetPhi(block)) {
+        current = phi;
+    }
+
+    for (auto *instr : block->GetInstructions()) {
+        auto *access = GetAccess(instr);
+        if (!access) {
+            continue;
+        }
+        Link(access, current);
+        if (access->kind == MemoryAccess::Kind::DEF) {
+            current = access;
+        }
+    }
+
+    for (auto *succ : block->GetSuccessors()) {
+        if (auto *phi = GetPhi(succ)) {
+            phi->incoming.emplace_back(block, current);
+            current->users.push_back(phi);
+        }
+    }
+
+    for (auto *succ : dom.GetDTreeSuccessor(block)) {
+        Rename(succ, current);
+    }
+}
+
+void MemorySSAAnalyzer::Link(MemoryAccess *user, MemoryAccess *def) {
+    user->defining = def;
+    def->users.push_back(user);
+}
+
+MemoryAccess *MemorySSAAnalyzer::GetClobber(MemoryAccess *access,
+                                            OperandBase *p,
+                                            const AliasAnalyzer &aa) const {
+    auto *clobber = access->defining;
+    while (clobber && clobber->kind == MemoryAccess::Kind::DEF &&
+           !aa.MayModify(clobber->instr, p)) {
+        clobber = clobber->defining;
+    }
+    return clobber;
+}
+
+bool MemorySSAAnalyzer::Dominates(InstructionBase *a,
+                                  InstructionBase *b) const {
+    if (a->GetBlock() == b->GetBlock()) {
+        return a->GetIndex() < b->GetIndex();
+    }
+    return dom.Dominates(a->GetBlock(), b->GetBlock());
+}
+
+std::string MemorySSAAnalyzer::GetName(const MemoryAccess *access) {
+    if (!access) {
+        return "unreachable";
+    }
+    return access->kind == MemoryAccess::Kind::ENTRY
+               ? "entry"
+               : std::format("m{}", access->id);
+}
+
+void MemorySSAAnalyzer::DumpMemorySSA(std::ostream &out) const {
+    out << "Memory SSA: " << func->GetName() << "\n";
+    for (auto *block : func->GetBlocks()) {
+        out << "  " << block->GetName() << ":\n";
+        if (auto *phi = GetPhi(block)) {
+            out << "    " << GetName(phi) << " = phi";
+            for (auto &[pred, def] : phi->incoming) {
+                out << " " << pred->GetName() << ": " << GetName(def);
+            }
+            out << "\n";
+        }
+        for (auto *instr : block->GetInstructions()) {
+            auto *access = GetAccess(instr);
+            if (!access) {
+                continue;
+            }
+            out << "    ";
+            if (access->kind == MemoryAccess::Kind::DEF) {
+                out << GetName(access) << " = def(" << GetName(access->defining)
+                    << "): ";
+            } else {
+                out << "use(" << GetName(access->defining) << "): ";
+            }
+            instr->Dump(out);
+        }
+    }
+}
+// MemorySSAAnalyzer end
+} // namespace sc
@@ -0,0 +1,495 @@
+#include "analyzers/range_analyzer.hpp"
+#include "analyzers/cfg.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include <algorithm>
+#include <ranges>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// Rounds a get may grow before its range is widened
+static constexpr size_t widen_after = 2;
+// Rounds recomputing every range after the widened ones are stable
+static constexpr size_t narrow_rounds = 2;
+
+static Range Hull(const Range &a, const Range &b) {
+    return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)};
+}
+
+// std::nullopt when the result may overflow
+static std::optional<Range> Corners(const Range &a, const Range &b,
+                                    bool (*op)(int64_t, int64_t, int64_t *)) {
+    std::optional<Range> range;
+    for (auto x : {a.lo, a.hi}) {
+        for (auto y : {b.lo, b.hi}) {
+            int64_t z;
+            if (op(x, y, &z)) {
+                return std::nullopt;
+            }
+            range = range ? Hull(*range, Range::Of(z)) : Range::Of(z);
+        }
+    }
+    return range;
+}
+
+static Range Add(const Range &a, const Range &b) {
+    return Corners(a, b, [](int64_t x, int64_t y, int64_t *z) {
+               return __builtin_add_overflow(x, y, z);
+           })
+        .value_or(Range{});
+}
+
+static Range Sub(const Range &a, const Range &b) {
+    return Corners(a, b, [](int64_t x, int64_t y, int64_t *z) {
+               return __builtin_sub_overflow(x, y, z);
+           })
+        .value_or(Range{});
+}
+
+static Range Mul(const Range &a, const Range &b) {
+    return Corners(a, b, [](int64_t x, int64_t y, int64_t *z) {
+               return __builtin_mul_overflow(x, y, z);
+           })
+        .value_or(Range{});
+}
+
+static Range Div(const Range &a, const Range &b) {
+    // Dividing by zero is an error, the quotient is monotonic in the
+    // divisor on either side of it
+    auto div = [](int64_t x, int64_t y, int64_t *z) {
+        if (x == std::numeric_limits<int64_t>::min() && y == -1) {
+            return true;
+        }
+        *z = x / y;
+        return false;
+    };
+
+    std::optional<Range> range;
+    for (auto side : {Range{b.lo, std::min(b.hi, int64_t{-1})},
+                      Range{std::max(b.lo, int64_t{1}), b.hi}}) {
+        if (side.lo > side.hi) {
+            continue;
+        }
+        auto quotient = Corners(a, side, div);
+        if (!quotient) {
+            return {};
+        }
+        range = range ? Hull(*range, *quotient) : *quotient;
+    }
+    return range.value_or(Range{});
+}
+
+static Range Compare(Opcode opcode, const Range &a, const Range &b) {
+    auto always = Range::Of(1);
+    auto never = Range::Of(0);
+    switch (opcode) {
+    case Opcode::EQ:
+        if (a.IsConstant() && a == b) {
+            return always;
+        }
+        return a.hi < b.lo || b.hi < a.lo ? never : Range{0, 1};
+    case Opcode::LT:
+        return a.hi < b.lo ? always : a.lo >= b.hi ? never : Range{0, 1};
+    case Opcode::LE:
+        return a.hi <= b.lo ? always : a.lo > b.hi ? never : Range{0, 1};
+    case Opcode::GT:
+        return a.lo > b.hi ? always : a.hi <= b.lo ? never : Range{0, 1};
+    case Opcode::GE:
+        return a.lo >= b.hi ? always : a.hi < b.lo ? never : Range{0, 1};
+    default:
+        __builtin_unreachable();
+    }
+}
+
+// RangeAnalyzer begin
+void RangeAnalyzer::Analyze() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    ranges.clear();
+    executable.clear();
+    constraints.clear();
+    grown.clear();
+
+    dom.BuildDominatorTree();
+    auto cfg = ForwardCFG(func);
+    rpo = GetReversePostOrder(&cfg);
+    FindConstraints();
+
+    executable.insert(func->GetBlock(0));
+    while (Propagate(true)) {
+    }
+    for (auto i = 0ul; i < narrow_rounds; ++i) {
+        Propagate(false);
+    }
+}
+
+void RangeAnalyzer::FindConstraints() {
+    for (auto *block : func->GetBlocks()) {
+        if (block->GetPredecessorSize() != 1) {
+            continue;
+        }
+
+        auto *pred = block->GetPredecessor(0);
+        auto *last = LAST_INSTR(pred);
+        if (last->GetOpcode() != Opcode::BR) {
+            continue;
+        }
+        auto *br = static_cast<BranchInstruction *>(last);
+        auto *true_blk = br->GetTrueDest()->GetBlock();
+        if (true_blk != br->GetFalseDest()->GetBlock()) {
+            AddConstraints(block, br->GetOperand(0), true_blk == block);
+        }
+    }
+}
+
+void RangeAnalyzer::AddConstraints(Block *block, OperandBase *cond,
+                                   bool taken) {
+    auto &list = constraints[block];
+    list.push_back({cond, Relation::EQ, nullptr, taken});
+
+    auto *def = cond->GetDef();
+    if (!def) {
+        return;
+    }
+
+    auto relation = Relation::EQ;
+    switch (def->GetOpcode()) {
+    case Opcode::NOT:
+        AddConstraints(block, def->GetOperand(0), !taken);
+        return;
+    case Opcode::AND:
+    case Opcode::OR:
+        // Both operands are known when the and is true or the or false
+        if (taken == (def->GetOpcode() == Opcode::AND)) {
+            AddConstraints(block, def->GetOperand(0), taken);
+            AddConstraints(block, def->GetOperand(1), taken);
+        }
+        return;
+    case Opcode::EQ:
+        relation = taken ? Relation::EQ : Relation::NE;
+        break;
+    case Opcode::LT:
+        relation = taken ? Relation::LT : Relation::GE;
+        break;
+    case Opcode::LE:
+        relation = taken ? Relation::LE : Relation::GT;
+        break;
+    case Opcode::GT:
+        relation = taken ? Relation::GT : Relation::LE;
+        break;
+    case Opcode::GE:
+        relation = taken ? Relation::GE : Relation::LT;
+        break;
+    default:
+        return;
+    }
+
+    // Seen from the other operand
+    auto swapped = relation;
+    switch (relation) {
+    case Relation::LT:
+        swapped = Relation::GT;
+        break;
+    case Relation::LE:
+        swapped = Relation::GE;
+        break;
+    case Relation::GT:
+        swapped = Relation::LT;
+        break;
+    case Relation::GE:
+        swapped = Relation::LE;
+        break;
+    default:
+        break;
+    }
+
+    auto *x = def->GetOperand(0);
+    auto *y = def->GetOperand(1);
+    list.push_back({x, relation, y, 0});
+    list.push_back({y, swapped, x, 0});
+}
+
+bool RangeAnalyzer::Propagate(bool widen) {
+    bool changed = false;
+    for (auto *block : rpo) {
+        if (!IsExecutable(block)) {
+            continue;
+        }
+
+        for (auto *instr : block->GetInstructions()) {
+            if (!instr->HasDest()) {
+                continue;
+            }
+            auto *dest = instr->GetDest();
+            if (dest->GetType() != DataType::INT &&
+                dest->GetType() != DataType::BOOL) {
+                continue;
+            }
+
+            auto range = Evaluate(instr);
+            if (!range) {
+                continue;
+            }
+
+            auto it = ranges.find(dest);
+            if (it != ranges.end()) {
+                auto old = it->second;
+                if (widen) {
+                    // Ranges only grow until they are stable
+                    range = Hull(old, *range);
+                    if (instr->GetOpcode() == Opcode::GET && *range != old &&
+                        ++grown[instr] > widen_after) {
+                        if (range->lo < old.lo) {
+                            range->lo = std::numeric_limits<int64_t>::min();
+                        }
+                        if (range->hi > old.hi) {
+                            range->hi = std::numeric_limits<int64_t>::max();
+                        }
+                    }
+                } else {
+                    // Both are sound, the narrowed one is kept
+                    range = {std::max(old.lo, range->lo),
+                             std::min(old.hi, range->hi)};
+                    if (range->lo > range->hi) {
+                        continue;
+                    }
+                }
+                if (*range == old) {
+                    continue;
+                }
+            }
+
+#ifdef PRINT_DEBUG
+            std::cerr << "  " << dest->GetName() << ": [" << range->lo << ", "
+                      << range->hi << "]\n";
+#endif
+            ranges[dest] = *range;
+            changed = true;
+        }
+
+        for (auto *succ : block->GetSuccessors()) {
+            if (!IsExecutable(succ) && IsExecutable(block, succ)) {
+                executable.insert(succ);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+std::optional<Range> RangeAnalyzer::Evaluate(InstructionBase *instr) const {
+    auto *block = instr->GetBlock();
+    auto operand = [this, instr, block](size_t idx) {
+        return GetRange(instr->GetOperand(idx), block);
+    };
+
+    auto opcode = instr->GetOpcode();
+    switch (opcode) {
+    case Opcode::CONST:
+        if (instr->GetDest()->GetType() == DataType::INT) {
+            return Range::Of(
+                static_cast<IntOperand *>(instr->GetOperand(0))->GetValue());
+        }
+        return Range::Of(
+            static_cast<BoolOperand *>(instr->GetOperand(0))->GetValue());
+    case Opcode::ID:
+        return operand(0);
+    case Opcode::GET:
+        return EvaluateGet(static_cast<GetInstruction *>(instr));
+    case Opcode::UNDEF:
+        return std::nullopt;
+    case Opcode::NOT: {
+        auto a = operand(0);
+        if (!a) {
+            return std::nullopt;
+        }
+        return Range{1 - a->hi, 1 - a->lo};
+    }
+    case Opcode::ADD:
+    case Opcode::SUB:
+    case Opcode::MUL:
+    case Opcode::DIV:
+    case Opcode::EQ:
+    case Opcode::LT:
+    case Opcode::LE:
+    case Opcode::GT:
+    case Opcode::GE:
+    case Opcode::AND:
+    case Opcode::OR: {
+        auto a = operand(0);
+        auto b = operand(1);
+        if (!a || !b) {
+            return std::nullopt;
+        }
+
+        if (opcode == Opcode::ADD) {
+            return Add(*a, *b);
+        } else if (opcode == Opcode::SUB) {
+            return Sub(*a, *b);
+        } else if (opcode == Opcode::MUL) {
+            return Mul(*a, *b);
+        } else if (opcode == Opcode::DIV) {
+            return Div(*a, *b);
+        } else if (opcode == Opcode::AND) {
+            return Range{a->lo & b->lo, a->hi & b->hi};
+        } else if (opcode == Opcode::OR) {
+            return Range{a->lo | b->lo, a->hi | b->hi};
+        }
+        return Compare(opcode, *a, *b);
+    }
+    default:
+        // Arguments, loads, calls and float comparisons may be anything
+        if (instr->GetDest()->GetType() == DataType::BOOL) {
+            return Range{0, 1};
+        }
+        return Range{};
+    }
+}
+
+std::optional<Range> RangeAnalyzer::EvaluateGet(GetInstruction *instr) const {
+    std::optional<Range> range;
+    for (auto *seti : instr->GetSetPairs()) {
+        auto *from = seti->GetBlock();
+        if (!IsExecutable(from, instr->GetBlock())) {
+            continue;
+        }
+
+        auto value = GetRange(seti->GetOperand(0), from);
+        if (value) {
+            range = range ? Hull(*range, *value) : *value;
+        }
+    }
+    return range;
+}
+
+bool RangeAnalyzer::IsExecutable(Block *block, Block *succ) const {
+    if (!IsExecutable(block)) {
+        return false;
+    }
+
+    auto *last = LAST_INSTR(block);
+    if (last->GetOpcode() != Opcode::BR) {
+        return true;
+    }
+
+    auto *br = static_cast<BranchInstruction *>(last);
+    auto cond = GetRange(br->GetOperand(0), block);
+    if (!cond) {
+        return false;
+    }
+    return (br->GetTrueDest()->GetBlock() == succ && cond->hi == 1) ||
+           (br->GetFalseDest()->GetBlock() == succ && cond->lo == 0);
+}
+
+std::optional<Range> RangeAnalyzer::GetRange(OperandBase *op) const {
+    auto it = ranges.find(op);
+    if (it == ranges.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<Range> RangeAnalyzer::GetRange(OperandBase *op,
+                                             Block *block) const {
+    auto range = GetRange(op);
+    for (auto *b = block; range && b;
+         b = dom.GetImmediateDominator(b->GetIndex())) {
+        auto it = constraints.find(b);
+        if (it == constraints.end()) {
+            continue;
+        }
+
+        for (auto &constraint : it->second) {
+            if (constraint.op != op) {
+                continue;
+            }
+
+            auto other = Range::Of(constraint.value);
+            if (constraint.other) {
+                // Known where the condition is computed
+                auto value = GetRange(constraint.other, b->GetPredecessor(0));
+                if (!value) {
+                    continue;
+                }
+                other = *value;
+            }
+            range = Apply(*range, constraint.relation, other);
+            if (!range) {
+                break;
+            }
+        }
+    }
+    return range;
+}
+
+std::optional<Range> RangeAnalyzer::Apply(Range range, Relation relation,
+                                          Range other) {
+    switch (relation) {
+    case Relation::EQ:
+        range = {std::max(range.lo, other.lo), std::min(range.hi, other.hi)};
+        break;
+    case Relation::NE:
+        if (other.IsConstant()) {
+            if (range.IsConstant() && range.lo == other.lo) {
+                return std::nullopt;
+            }
+            if (range.lo == other.lo) {
+                ++range.lo;
+            } else if (range.hi == other.lo) {
+                --range.hi;
+            }
+        }
+        break;
+    case Relation::LT:
+        if (other.hi == std::numeric_limits<int64_t>::min()) {
+            return std::nullopt;
+        }
+        range.hi = std::min(range.hi, other.hi - 1);
+        break;
+    case Relation::LE:
+        range.hi = std::min(range.hi, other.hi);
+        break;
+    case Relation::GT:
+        if (other.lo == std::numeric_limits<int64_t>::max()) {
+            return std::nullopt;
+        }
+        range.lo = std::max(range.lo, other.lo + 1);
+        break;
+    case Relation::GE:
+        range.lo = std::max(range.lo, other.lo);
+        break;
+    }
+
+    if (range.lo > range.hi) {
+        return std::nullopt;
+    }
+    return range;
+}
+
+void RangeAnalyzer::DumpRanges(std::ostream &out) const {
+    out << "Value Ranges: " << func->GetName() << "\n";
+    for (auto *block : func->GetBlocks()) {
+        out << "  " << block->GetName() << ":";
+        if (!IsExecutable(block)) {
+            out << " unreachable\n";
+            continue;
+        }
+        out << "\n";
+
+        for (auto *instr : block->GetInstructions()) {
+            if (!instr->HasDest()) {
+                continue;
+            }
+            if (auto range = GetRange(instr->GetDest())) {
+                out << "    " << instr->GetDest()->GetName() << ": ["
+                    << range->lo << ", " << range->hi << "]\n";
+            }
+        }
+    }
+}
+// RangeAnalyzer end
+} // namespace sc
@@ -0,0 +1,157 @@
+#include "analyzers/summary_analyzer.hpp"
+#include "opcodes.hpp"
+#include "statistics.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+
+// Whether the CFG of func has a cycle, blocks are removed in topological
+// order until none is left without predecessors
+static bool HasCycle(Function *func) {
+    std::unordered_map<Block *, size_t> preds;
+    std::vector<Block *> worklist;
+    for (auto *block : func->GetBlocks()) {
+        preds[block] = block->GetPredecessorSize();
+        if (!preds[block]) {
+            worklist.push_back(block);
+        }
+    }
+
+    size_t removed = 0;
+    while (!worklist.empty()) {
+        auto *block = worklist.back();
+        worklist.pop_back();
+        ++removed;
+        for (auto *succ : block->GetSuccessors()) {
+            if (!--preds[succ]) {
+                worklist.push_back(succ);
+            }
+        }
+    }
+    return removed != func->GetBlockSize();
+}
+
+// SummaryAnalyzer begin
+void SummaryAnalyzer::Analyze() {
+    cg.Analyze();
+    summaries.clear();
+
+    for (auto &scc : cg.GetSCCs()) {
+        // Functions of the component start without effects, the callees
+        // outside of it are already summarized
+        for (auto *func : scc) {
+            summaries[func] = {};
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto *func : scc) {
+                auto summary = Summarize(func);
+                if (summary.effects != summaries[func].effects) {
+                    summaries[func] = summary;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+#ifdef PRINT_DEBUG
+    DumpSummaries(std::cerr);
+#endif
+}
+
+FunctionSummary SummaryAnalyzer::Summarize(Function *func) const {
+    FunctionSummary summary;
+    if (cg.IsRecursive(func) || HasCycle(func)) {
+        summary.effects |= FunctionSummary::DIVERGES;
+    }
+
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            switch (instr->GetOpcode()) {
+            case Opcode::LOAD:
+                summary.effects |=
+                    FunctionSummary::READS | FunctionSummary::DIVERGES;
+                break;
+            case Opcode::DIV:
+                summary.effects |= FunctionSummary::DIVERGES;
+                break;
+            case Opcode::STORE:
+                summary.effects |= FunctionSummary::WRITES;
+                break;
+            case Opcode::PRINT:
+                summary.effects |= FunctionSummary::PRINTS;
+                break;
+            case Opcode::ALLOC:
+                summary.effects |= FunctionSummary::ALLOCATES;
+                break;
+            case Opcode::FREE:
+                summary.effects |= FunctionSummary::FREES;
+                break;
+            case Opcode::CALL: {
+                auto *call = static_cast<CallInstruction *>(instr);
+                auto *callee = cg.GetFunction(call->GetFuncName());
+                auto it = summaries.find(callee);
+                summary.effects |= it == summaries.end()
+                                       ? uint8_t{FunctionSummary::ALL}
+                                       : it->second.effects;
+            } break;
+            default:
+                break;
+            }
+        }
+    }
+    return summary;
+}
+
+void SummaryAnalyzer::DumpSummaries(std::ostream &out) const {
+    static constexpr std::pair<FunctionSummary::Effect, const char *>
+        names[] = {
+            {FunctionSummary::READS, "reads"},
+            {FunctionSummary::WRITES, "writes"},
+            {FunctionSummary::PRINTS, "prints"},
+            {FunctionSummary::ALLOCATES, "allocates"},
+            {FunctionSummary::FREES, "frees"},
+            {FunctionSummary::DIVERGES, "diverges"},
+        };
+
+    out << "Function Summaries:\n";
+    for (auto &f : *program) {
+        auto &summary = summaries.at(f.get());
+        out << "  " << f->GetName() << ":";
+        if (summary.IsPure()) {
+            out << " pure";
+        }
+        for (auto &[effect, name] : names) {
+            if (summary.Has(effect)) {
+                out << " " << name;
+            }
+        }
+        out << "\n";
+    }
+}
+
+void SummarizeCalls(Program *program) {
+    SummaryAnalyzer summaries(program);
+    summaries.Analyze();
+
+    auto &cg = summaries.GetCallGraph();
+    size_t pure = 0;
+    for (auto &f : *program) {
+        pure += summaries.GetSummary(f.get()).IsPure();
+        for (auto *callee : cg.GetCallees(f.get())) {
+            f->SetCalleeSummary(callee->GetName(),
+                                summaries.GetSummary(callee));
+        }
+    }
+
+    Statistics::Get().Add("ipa.pure", pure);
+}
+// SummaryAnalyzer end
+} // namespace sc
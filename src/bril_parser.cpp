@@ -1,16 +1,21 @@
 #include "bril_parser.hpp"
 #include "block.hpp"
 #include "function.hpp"
+#include "function_stream.hpp"
 #include "instruction.hpp"
 #include "json.hpp"
 #include "operand.hpp"
 #include "program.hpp"
+#include "thread_pool.hpp"
 #include <format>
+#include <future>
 #include <memory>
 #include <optional>
 #include <ranges>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace sc {
 FuncPtr BrilParser::MakeNewBlock(FuncPtr func, std::string name) {
@@ -373,17 +378,43 @@ std::unique_ptr<Function> BrilParser::ParseFunction(sjp::Json &jfunc) {
     return func;
 }
 
+FuncPtr BrilParser::ParseFunction(const std::string &text) {
+    std::istringstream iss(text);
+    auto json_parser = sjp::Parser(iss);
+    sjp::Json jfunc = json_parser.Parse();
+    auto parser = BrilParser();
+    return parser.ParseFunction(jfunc);
+}
+
 std::unique_ptr<Program> BrilParser::ParseProgram(std::istream &input) {
-    auto json_parser = sjp::Parser(input);
-    sjp::Json data = json_parser.Parse();
+    // Functions only refer to each other by name, so their bodies are
+    // parsed concurrently while the stream looks for the next one. The
+    // pool is shared by every call to avoid starting threads per program.
+    static ThreadPool pool;
+
+    std::vector<std::future<FuncPtr>> funcs;
+    auto stream = FunctionStream(input);
+    std::string text;
+    while (stream.Next(text)) {
+        funcs.push_back(pool.Submit(
+            [text = std::move(text)] { return ParseFunction(text); }));
+    }
 
+    // Merged in source order, errors are reported for the first
+    // function that failed to parse.
     auto program = std::make_unique<Program>();
-    auto functions = data.Get("functions");
-    for (size_t i : std::views::iota(0UL, functions->Size())) {
-        auto jfunc = functions->Get(i).value();
-        auto parser = BrilParser();
-        program->AddFunction(parser.ParseFunction(jfunc));
+    for (auto &func : funcs) {
+        program->AddFunction(func.get());
     }
     return program;
 }
+
+void BrilParser::StreamProgram(std::istream &input,
+                               std::function<void(FuncPtr)> callback) {
+    auto stream = FunctionStream(input);
+    std::string text;
+    while (stream.Next(text)) {
+        callback(ParseFunction(text));
+    }
+}
 } // namespace sc
@@ -0,0 +1,131 @@
+#include "compile_cache.hpp"
+#include "ir_serializer.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace sc {
+CompileCache::CompileCache(fs::path _dir, std::string _config,
+                           uintmax_t _max_size)
+    : dir(std::move(_dir)), config(std::move(_config)), max_size(_max_size),
+      size(0) {
+    fs::create_directories(dir);
+    for (auto &entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file()) {
+            size += entry.file_size();
+        }
+    }
+}
+
+CompileCache::Digest CompileCache::Hash(std::string_view data, Digest seed) {
+    // FNV-1a, stable across runs and platforms unlike std::hash. The prime
+    // is 2^88 + 0x13b, the product is computed on the 64 bit halves.
+    constexpr uint64_t low = 0x13b;
+    auto hash = seed;
+    for (auto c : data) {
+        hash.lo ^= static_cast<unsigned char>(c);
+
+        auto lo_lo = (hash.lo & 0xffffffff) * low;
+        auto lo_hi = (hash.lo >> 32) * low;
+        auto lo = lo_lo + (lo_hi << 32);
+        auto carry = (lo_hi >> 32) + (lo < lo_lo ? 1 : 0);
+        hash.hi = hash.hi * low + carry + (hash.lo << 24);
+        hash.lo = lo;
+    }
+    return hash;
+}
+
+std::string CompileCache::GetKey(Function *func) const {
+    // The binary snapshot is used instead of the textual dump since
+    // it keeps the exact value of float constants.
+    std::stringstream snapshot;
+    WriteIR(func, snapshot, "parse");
+    auto ir = snapshot.str();
+
+    auto hash = Hash(ir, Hash(config));
+    return std::format("{:016x}{:016x}", hash.hi, hash.lo);
+}
+
+std::optional<std::string> CompileCache::Lookup(const std::string &key) {
+    auto path = dir / key;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        Statistics::Get().Add("cache.misses");
+        return std::nullopt;
+    }
+
+    std::stringstream text;
+    text << in.rdbuf();
+
+    // Refresh the entry so that it is evicted last
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    Statistics::Get().Add("cache.hits");
+    return text.str();
+}
+
+void CompileCache::Store(const std::string &key, const std::string &text) {
+    auto path = dir / key;
+    auto tmp = dir / std::format("{}.{}.{}.tmp", key, getpid(),
+                                 std::hash<std::thread::id>()(
+                                     std::this_thread::get_id()));
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return;
+    }
+
+    Statistics::Get().Add("cache.stores");
+    std::lock_guard<std::mutex> lock(mtx);
+    size += text.size();
+    if (size > max_size) {
+        Evict();
+    }
+}
+
+void CompileCache::Evict() {
+    // Other processes may share the directory so the size is recomputed
+    // from the entries on disk instead of trusting the running total.
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    size = 0;
+    std::error_code ec;
+    for (auto &entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() == ".tmp") {
+            continue;
+        }
+        size += entry.file_size(ec);
+        entries.emplace_back(entry.last_write_time(ec), entry.path());
+    }
+
+    std::ranges::sort(entries);
+    for (auto &[time, path] : entries) {
+        if (size <= max_size) {
+            break;
+        }
+        auto file_size = fs::file_size(path, ec);
+        if (!ec && fs::remove(path, ec)) {
+            size -= file_size;
+            Statistics::Get().Add("cache.evictions");
+        }
+    }
+}
+} // namespace sc
@@ -0,0 +1,219 @@
+#include "compile_server.hpp"
+#include "statistics.hpp"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sc {
+static bool ReadAll(int fd, char *data, size_t size) {
+    while (size) {
+        auto n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool WriteAll(int fd, const char *data, size_t size) {
+    while (size) {
+        auto n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Larger frames are rejected before anything is allocated for them
+static constexpr uint32_t max_frame_size = 256 << 20;
+
+static bool ReadFrame(int fd, std::string &buffer) {
+    uint32_t size;
+    if (!ReadAll(fd, reinterpret_cast<char *>(&size), sizeof(size)) ||
+        size > max_frame_size) {
+        return false;
+    }
+    buffer.resize(size);
+    return ReadAll(fd, buffer.data(), size);
+}
+
+static bool WriteFrame(int fd, const std::string &text) {
+    auto size = static_cast<uint32_t>(text.size());
+    return WriteAll(fd, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+           WriteAll(fd, text.data(), text.size());
+}
+
+static sockaddr_un GetAddress(const std::string &path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(
+            std::format("Socket path {} is too long.\n", path));
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+CompileServer::Reply CompileServer::Compile(const std::string &request) {
+    auto start = std::chrono::steady_clock::now();
+    Reply reply;
+    try {
+        std::istringstream input(request);
+        reply = {true, compile(input)};
+    } catch (const std::exception &e) {
+        reply = {false, e.what()};
+    }
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    Statistics::Get().Add("server.requests");
+    Statistics::Get().Add("server.latency_us",
+                          static_cast<size_t>(elapsed.count()));
+    if (time) {
+        std::cerr << std::format("request: {:.3f} ms\n",
+                                 elapsed.count() / 1000);
+    }
+    return reply;
+}
+
+void CompileServer::Serve(const std::string &path) {
+    // Clients that go away must not take down the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    auto addr = GetAddress(path);
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to create socket.\n");
+    }
+
+    // Remove the socket left behind by a previous server
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        throw std::runtime_error(
+            std::format("Unable to listen on {}: {}.\n", path,
+                        std::strerror(errno)));
+    }
+
+    while (true) {
+        auto conn = accept(fd, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            close(fd);
+            throw std::runtime_error(
+                std::format("Unable to accept: {}.\n", std::strerror(errno)));
+        }
+        // The thread of a connection only reads and writes frames, its
+        // requests are compiled on the pool like those of a stream
+        std::thread([this, conn] {
+            Serve(conn, conn);
+            close(conn);
+        }).detach();
+    }
+}
+
+void CompileServer::Serve(int in, int out) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Requests are read ahead and compiled concurrently while the
+    // replies are written back in order.
+    std::queue<std::future<Reply>> pending;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+
+    std::thread reader([&] {
+        std::string request;
+        while (ReadFrame(in, request)) {
+            auto reply = pool.Submit(
+                [this, request = std::move(request)] { return Compile(request); });
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                pending.push(std::move(reply));
+            }
+            cv.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done = true;
+        }
+        cv.notify_one();
+    });
+
+    while (true) {
+        std::future<Reply> future;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return done || !pending.empty(); });
+            if (pending.empty()) {
+                break;
+            }
+            future = std::move(pending.front());
+            pending.pop();
+        }
+
+        auto reply = future.get();
+        uint8_t status = reply.ok ? 0 : 1;
+        if (!WriteAll(out, reinterpret_cast<const char *>(&status), 1) ||
+            !WriteFrame(out, reply.text)) {
+            break;
+        }
+    }
+
+    reader.join();
+}
+
+bool RunClient(const std::string &path, const std::string &program,
+               std::ostream &out, std::ostream &err, int &status) {
+    // A server that crashes is reported through the return value
+    std::signal(SIGPIPE, SIG_IGN);
+
+    auto addr = GetAddress(path);
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    std::string reply;
+    uint8_t ok;
+    auto *ptr = reinterpret_cast<sockaddr *>(&addr);
+    if (connect(fd, ptr, sizeof(addr)) < 0 || !WriteFrame(fd, program) ||
+        !ReadAll(fd, reinterpret_cast<char *>(&ok), 1) ||
+        !ReadFrame(fd, reply)) {
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    if (ok == 0) {
+        out << reply;
+        status = 0;
+    } else {
+        err << reply;
+        status = 1;
+    }
+    return true;
+}
+} // namespace sc
@@ -1,9 +1,10 @@
 #include "function.hpp"
 #include "block.hpp"
 #include "operand.hpp"
+#include <ranges>
 
 namespace sc {
-void Function::Dump(std::ostream &out) const {
+void Function::Dump(std::ostream &out, bool fallthrough) const {
     out << "@" << name;
     if (args) {
         out << "(";
@@ -24,9 +25,12 @@ void Function::Dump(std::ostream &out) const {
         out << ": " << GetStrRetType();
     }
     out << " {\n";
-    for (auto &block : blocks) {
-        out << "." << block->GetName() << ":\n";
-        block->Dump(out, "  ");
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        out << "." << blocks[i]->GetName() << ":\n";
+        auto *next = (fallthrough && i + 1 < blocks.size())
+                         ? blocks[i + 1].get()
+                         : nullptr;
+        blocks[i]->Dump(out, "  ", next);
     }
     out << "}\n";
 }
@@ -78,4 +82,144 @@ void Function::DumpDefUseLinks(std::ostream &out) const {
 }
 
 std::string PtrFunction::GetStrRetType() const { return GetPtrType(ptr_chain); }
+
+void RedirectEdge(Block *from, Block *to, Block *new_to) {
+    auto *instr = LAST_INSTR(from);
+    if (instr->GetOpcode() == Opcode::JMP) {
+        static_cast<JmpInstruction *>(instr)->SetJmpDest(new_to->GetLabel());
+    } else {
+        assert(instr->GetOpcode() == Opcode::BR);
+        auto *br = static_cast<BranchInstruction *>(instr);
+        if (br->GetTrueDest()->GetBlock() == to) {
+            br->SetTrueDest(new_to->GetLabel());
+        }
+        if (br->GetFalseDest()->GetBlock() == to) {
+            br->SetFalseDest(new_to->GetLabel());
+        }
+    }
+
+    for (auto i : std::views::iota(0ul, from->GetSuccessorSize())) {
+        if (from->GetSuccessor(i) == to) {
+            from->AddSuccessor(new_to, i);
+            to->RemovePredecessor(from);
+            new_to->AddPredecessor(from);
+        }
+    }
+}
+
+void ReplaceWithJmp(Block *block, Block *target) {
+    for (auto *succ : block->GetSuccessors()) {
+        succ->RemovePredecessor(block);
+    }
+    while (block->GetSuccessorSize()) {
+        block->RemoveSuccessor(block->GetSuccessorSize() - 1);
+    }
+
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(target->GetLabel());
+    block->AddInstruction(std::move(jmp_instr),
+                          block->GetInstructionSize() - 1);
+    block->AddSuccessor(target);
+    target->AddPredecessor(block);
+}
+
+std::unordered_map<Block *, Block *>
+CloneBlocks(Function *func, const std::vector<Block *> &blocks,
+            const std::string &prefix, size_t idx) {
+    std::unordered_map<Block *, Block *> clones;
+    std::vector<std::unique_ptr<Block>> new_blocks;
+    for (auto *block : blocks) {
+        auto name = prefix + block->GetName();
+        auto clone = std::make_unique<Block>(name);
+        auto label = std::make_unique<LabelOperand>(name);
+        label->SetBlock(clone.get());
+        clone->SetLabel(std::move(label));
+        clones[block] = clone.get();
+        new_blocks.push_back(std::move(clone));
+    }
+
+    auto get_clone = [&clones](LabelOperand *label) {
+        auto it = clones.find(label->GetBlock());
+        return it == clones.end() ? label : it->second->GetLabel();
+    };
+
+    for (auto *block : blocks) {
+        auto *clone = clones[block];
+        for (auto *instr : block->GetInstructions()) {
+            clone->AddInstruction(CloneInstruction(instr));
+        }
+
+        // Successors are kept in the order of the branch targets
+        auto *instr = LAST_INSTR(clone);
+        if (instr->GetOpcode() == Opcode::JMP) {
+            auto *jmp = static_cast<JmpInstruction *>(instr);
+            jmp->SetJmpDest(get_clone(jmp->GetJmpDest()));
+        } else if (instr->GetOpcode() == Opcode::BR) {
+            auto *br = static_cast<BranchInstruction *>(instr);
+            br->SetTrueDest(get_clone(br->GetTrueDest()));
+            br->SetFalseDest(get_clone(br->GetFalseDest()));
+        }
+        for (auto *succ : block->GetSuccessors()) {
+            auto it = clones.find(succ);
+            auto *target = it == clones.end() ? succ : it->second;
+            clone->AddSuccessor(target);
+            target->AddPredecessor(clone);
+        }
+    }
+
+    for (auto &block : new_blocks | std::views::reverse) {
+        func->InsertBlock(std::move(block), idx);
+    }
+    return clones;
+}
+
+std::unique_ptr<Function> CloneFunction(Function *func,
+                                        const std::string &name) {
+    std::unique_ptr<Function> clone = nullptr;
+    if (func->GetRetType() == DataType::PTR) {
+        auto ptr_clone = std::make_unique<PtrFunction>(name);
+        for (auto type : static_cast<PtrFunction *>(func)->GetPtrChain()) {
+            ptr_clone->AppendPtrChain(type);
+        }
+        clone = std::move(ptr_clone);
+    } else {
+        clone = std::make_unique<Function>(name, func->GetRetType());
+    }
+    clone->SetArgs(func->HasArgs());
+    clone->SetArgsSize(func->GetArgsSize());
+    for (auto &[callee, summary] : func->GetCalleeSummaries()) {
+        clone->SetCalleeSummary(callee, summary);
+    }
+
+    std::vector<Block *> blocks;
+    for (auto *block : func->GetBlocks()) {
+        blocks.push_back(block);
+    }
+    CloneBlocks(clone.get(), blocks, "", 0);
+
+    // The cloned instructions still refer to the variables of func
+    std::unordered_map<OperandBase *, std::shared_ptr<OperandBase>> vars;
+    for (auto *block : clone->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->HasDest() && !vars.contains(instr->GetDest())) {
+                vars[instr->GetDest()] = instr->GetDest()->Clone();
+            }
+        }
+    }
+
+    for (auto *block : clone->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->HasDest()) {
+                instr->AddDest(vars.at(instr->GetDest()));
+            }
+            for (auto i : std::views::iota(0ul, instr->GetOperandSize())) {
+                auto it = vars.find(instr->GetOperand(i));
+                if (it != vars.end()) {
+                    instr->SetOperand(it->second.get(), i);
+                }
+            }
+        }
+    }
+    return clone;
+}
 } // namespace sc
@@ -0,0 +1,117 @@
+#include "function_stream.hpp"
+#include <cctype>
+#include <stdexcept>
+
+namespace sc {
+// FunctionStream begin
+bool FunctionStream::Next(std::string &text) {
+    if (!located) {
+        Locate();
+    }
+
+    if (done) {
+        return false;
+    }
+
+    SkipWhitespace();
+    if (Peek() == ',') {
+        Get();
+        SkipWhitespace();
+    }
+
+    if (Peek() == ']') {
+        Get();
+        done = true;
+        return false;
+    }
+
+    if (Peek() != '{') {
+        throw std::runtime_error(
+            "Error parsing program. Expected function object.\n");
+    }
+
+    text.clear();
+    size_t depth = 0;
+    do {
+        auto c = Get();
+        if (c == '"') {
+            text.push_back('"');
+            ReadString(&text);
+            text.push_back('"');
+            continue;
+        }
+
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+        text.push_back(static_cast<char>(c));
+    } while (depth);
+
+    return true;
+}
+
+void FunctionStream::Locate() {
+    // Walk the top-level object until the "functions" key is found,
+    // everything else is skipped without being materialized.
+    located = true;
+    size_t depth = 0;
+    std::string key;
+
+    while (true) {
+        auto c = Get();
+        if (c == '"') {
+            key.clear();
+            ReadString(&key);
+            SkipWhitespace();
+            if (depth == 1 && key == "functions" && Peek() == ':') {
+                Get();
+                SkipWhitespace();
+                if (Get() != '[') {
+                    throw std::runtime_error("Error parsing program. "
+                                             "Expected functions array.\n");
+                }
+                return;
+            }
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+    }
+}
+
+int FunctionStream::Get() {
+    auto c = input.get();
+    if (c == std::istream::traits_type::eof()) {
+        throw std::runtime_error("Error parsing program. "
+                                 "Unexpected end of input.\n");
+    }
+    return c;
+}
+
+int FunctionStream::Peek() { return input.peek(); }
+
+void FunctionStream::SkipWhitespace() {
+    while (std::isspace(Peek())) {
+        input.get();
+    }
+}
+
+void FunctionStream::ReadString(std::string *out) {
+    // Opening quote is already consumed, escapes are copied verbatim
+    // so that the text can still be handed to the json parser.
+    while (true) {
+        auto c = Get();
+        if (c == '"') {
+            return;
+        }
+        out->push_back(static_cast<char>(c));
+        if (c == '\\') {
+            out->push_back(static_cast<char>(Get()));
+        }
+    }
+}
+// FunctionStream end
+} // namespace sc
@@ -3,9 +3,11 @@
 #include "instruction_visitor.hpp"
 #include "operand.hpp"
 #include <cassert>
+#include <format>
 #include <iomanip>
 #include <iostream>
 #include <ranges>
+#include <stdexcept>
 #include <unordered_map>
 
 #define PRINT_HELPER3(name)                                                    \
@@ -273,5 +275,127 @@ void GetArgInstruction::Dump(std::ostream &out) const {
 
 ADD_VISITOR(GetArg)
 
+// clang-format on
+std::unique_ptr<InstructionBase> MakeInstruction(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::ADD:
+        return std::make_unique<AddInstruction>();
+    case Opcode::MUL:
+        return std::make_unique<MulInstruction>();
+    case Opcode::SUB:
+        return std::make_unique<SubInstruction>();
+    case Opcode::DIV:
+        return std::make_unique<DivInstruction>();
+    case Opcode::EQ:
+        return std::make_unique<EqInstruction>();
+    case Opcode::LT:
+        return std::make_unique<LtInstruction>();
+    case Opcode::GT:
+        return std::make_unique<GtInstruction>();
+    case Opcode::LE:
+        return std::make_unique<LeInstruction>();
+    case Opcode::GE:
+        return std::make_unique<GeInstruction>();
+    case Opcode::AND:
+        return std::make_unique<AndInstruction>();
+    case Opcode::OR:
+        return std::make_unique<OrInstruction>();
+    case Opcode::NOT:
+        return std::make_unique<NotInstruction>();
+    case Opcode::JMP:
+        return std::make_unique<JmpInstruction>();
+    case Opcode::BR:
+        return std::make_unique<BranchInstruction>();
+    case Opcode::CALL:
+        return std::make_unique<CallInstruction>();
+    case Opcode::RET:
+        return std::make_unique<RetInstruction>();
+    case Opcode::SET:
+        return std::make_unique<SetInstruction>();
+    case Opcode::GET:
+        return std::make_unique<GetInstruction>();
+    case Opcode::UNDEF:
+        return std::make_unique<UndefInstruction>();
+    case Opcode::ALLOC:
+        return std::make_unique<AllocInstruction>();
+    case Opcode::FREE:
+        return std::make_unique<FreeInstruction>();
+    case Opcode::LOAD:
+        return std::make_unique<LoadInstruction>();
+    case Opcode::STORE:
+        return std::make_unique<StoreInstruction>();
+    case Opcode::PTRADD:
+        return std::make_unique<PtraddInstruction>();
+    case Opcode::FADD:
+        return std::make_unique<FAddInstruction>();
+    case Opcode::FMUL:
+        return std::make_unique<FMulInstruction>();
+    case Opcode::FSUB:
+        return std::make_unique<FSubInstruction>();
+    case Opcode::FDIV:
+        return std::make_unique<FDivInstruction>();
+    case Opcode::FEQ:
+        return std::make_unique<FEqInstruction>();
+    case Opcode::FLT:
+        return std::make_unique<FLtInstruction>();
+    case Opcode::FLE:
+        return std::make_unique<FLeInstruction>();
+    case Opcode::FGT:
+        return std::make_unique<FGtInstruction>();
+    case Opcode::FGE:
+        return std::make_unique<FGeInstruction>();
+    case Opcode::ID:
+        return std::make_unique<IdInstruction>();
+    case Opcode::CONST:
+        return std::make_unique<ConstInstruction>();
+    case Opcode::PRINT:
+        return std::make_unique<PrintInstruction>();
+    case Opcode::NOP:
+        return std::make_unique<NopInstruction>();
+    case Opcode::GETARG:
+        return std::make_unique<GetArgInstruction>();
+    default:
+        throw std::runtime_error(
+            std::format("Invalid opcode {}.\n", static_cast<int>(opcode)));
+    }
+}
+
+std::unique_ptr<InstructionBase> CloneInstruction(InstructionBase *instr) {
+    auto clone = MakeInstruction(instr->GetOpcode());
+    if (instr->GetDest()) {
+        clone->AddDest(instr->CopyDest());
+    }
+    for (auto *op : instr->GetOperands()) {
+        clone->SetOperand(op);
+    }
+
+    switch (instr->GetOpcode()) {
+    case Opcode::JMP:
+        static_cast<JmpInstruction *>(clone.get())
+            ->SetJmpDest(static_cast<JmpInstruction *>(instr)->GetJmpDest());
+        break;
+    case Opcode::BR: {
+        auto *br = static_cast<BranchInstruction *>(instr);
+        auto *clone_br = static_cast<BranchInstruction *>(clone.get());
+        clone_br->SetTrueDest(br->GetTrueDest());
+        clone_br->SetFalseDest(br->GetFalseDest());
+    } break;
+    case Opcode::CALL: {
+        auto *call = static_cast<CallInstruction *>(instr);
+        auto *clone_call = static_cast<CallInstruction *>(clone.get());
+        clone_call->SetFuncName(call->GetFuncName());
+        clone_call->SetRetVal(call->HasDest());
+    } break;
+    case Opcode::SET:
+    case Opcode::GET:
+        assert(false && "CloneInstruction - SSA instructions can't be cloned\n");
+        break;
+    default:
+        break;
+    }
+    return clone;
+}
+// clang-format off
+
 } // namespace sc
 // clang-format on
@@ -0,0 +1,691 @@
+#include "ir_serializer.hpp"
+#include "block.hpp"
+#include "function.hpp"
+#include "instruction.hpp"
+#include "operand.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace sc {
+
+static constexpr char magic[4] = {'S', 'C', 'I', 'R'};
+static constexpr uint32_t version = 2;
+static constexpr uint32_t none = UINT32_MAX;
+
+// clang-format off
+enum class OperandTag : uint8_t {
+    NONE,
+    REG,
+    INT,
+    FLOAT,
+    BOOL,
+    UNDEF,
+    VOID,
+    LABEL
+};
+// clang-format on
+
+static OperandTag GetOperandTag(OperandBase *op) {
+    if (op == nullptr) {
+        return OperandTag::NONE;
+    } else if (op == VoidOperand::GetVoidOperand().get()) {
+        return OperandTag::VOID;
+    } else if (op == UndefOperand::GetUndefOperand().get()) {
+        return OperandTag::UNDEF;
+    } else if (dynamic_cast<IntOperand *>(op)) {
+        return OperandTag::INT;
+    } else if (dynamic_cast<FloatOperand *>(op)) {
+        return OperandTag::FLOAT;
+    } else if (dynamic_cast<BoolOperand *>(op)) {
+        return OperandTag::BOOL;
+    } else if (dynamic_cast<LabelOperand *>(op)) {
+        return OperandTag::LABEL;
+    }
+    return OperandTag::REG;
+}
+
+class IRWriter {
+  public:
+    IRWriter(std::ostream &_out) : out(_out) {}
+
+    void WriteFunctions(const std::vector<Function *> &funcs,
+                        const std::string &stage);
+
+  private:
+    std::ostream &out;
+
+    // Constant pool shared by all the functions
+    std::unordered_map<ValType::INT, uint32_t> ints;
+    std::unordered_map<uint64_t, uint32_t> floats;
+    std::vector<ValType::INT> int_pool;
+    std::vector<ValType::FLOAT> float_pool;
+
+    // Per function tables
+    std::unordered_map<OperandBase *, uint32_t> regs;
+    std::vector<OperandBase *> reg_list;
+    std::unordered_map<InstructionBase *, uint32_t> ids;
+    std::unordered_map<Block *, uint32_t> blocks;
+
+    template <typename T> void Write(T value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void WriteString(const std::string &str) {
+        Write(static_cast<uint32_t>(str.size()));
+        out.write(str.data(), static_cast<std::streamsize>(str.size()));
+    }
+
+    void WritePtrChain(const std::vector<DataType> &chain) {
+        Write(static_cast<uint32_t>(chain.size()));
+        for (auto type : chain) {
+            Write(static_cast<uint8_t>(type));
+        }
+    }
+
+    void CollectConstant(OperandBase *op);
+    void CollectOperand(OperandBase *op);
+    void CollectFunction(Function *func);
+    void WriteFunction(Function *func);
+    void WriteInstruction(InstructionBase *instr);
+    void WriteOperandRef(OperandBase *op);
+    void WriteInstrRef(InstructionBase *instr);
+};
+
+void IRWriter::WriteFunctions(const std::vector<Function *> &funcs,
+                              const std::string &stage) {
+    for (auto *f : funcs) {
+        for (auto *block : f->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                for (auto *op : instr->GetOperands()) {
+                    CollectConstant(op);
+                }
+            }
+        }
+    }
+
+    out.write(magic, sizeof(magic));
+    Write(version);
+    WriteString(stage);
+
+    Write(static_cast<uint32_t>(int_pool.size()));
+    for (auto value : int_pool) {
+        Write(value);
+    }
+    Write(static_cast<uint32_t>(float_pool.size()));
+    for (auto value : float_pool) {
+        Write(value);
+    }
+
+    Write(static_cast<uint32_t>(funcs.size()));
+    for (auto *f : funcs) {
+        WriteFunction(f);
+    }
+}
+
+void IRWriter::CollectConstant(OperandBase *op) {
+    switch (GetOperandTag(op)) {
+    case OperandTag::INT: {
+        auto value = static_cast<IntOperand *>(op)->GetValue();
+        if (!ints.contains(value)) {
+            ints[value] = static_cast<uint32_t>(int_pool.size());
+            int_pool.push_back(value);
+        }
+    } break;
+    case OperandTag::FLOAT: {
+        auto value = static_cast<FloatOperand *>(op)->GetValue();
+        auto bits = std::bit_cast<uint64_t>(value);
+        if (!floats.contains(bits)) {
+            floats[bits] = static_cast<uint32_t>(float_pool.size());
+            float_pool.push_back(value);
+        }
+    } break;
+    default:
+        break;
+    }
+}
+
+void IRWriter::CollectOperand(OperandBase *op) {
+    if (GetOperandTag(op) == OperandTag::REG && !regs.contains(op)) {
+        regs[op] = static_cast<uint32_t>(reg_list.size());
+        reg_list.push_back(op);
+    }
+}
+
+void IRWriter::CollectFunction(Function *func) {
+    regs.clear();
+    reg_list.clear();
+    ids.clear();
+    blocks.clear();
+
+    for (auto *block : func->GetBlocks()) {
+        blocks[block] = static_cast<uint32_t>(blocks.size());
+        for (auto *instr : block->GetInstructions()) {
+            ids[instr] = static_cast<uint32_t>(ids.size());
+            CollectOperand(instr->GetDest());
+            for (auto *op : instr->GetOperands()) {
+                CollectOperand(op);
+            }
+            if (instr->GetOpcode() == Opcode::SET) {
+                CollectOperand(static_cast<SetInstruction *>(instr)->GetShadow());
+            }
+        }
+    }
+}
+
+void IRWriter::WriteFunction(Function *func) {
+    CollectFunction(func);
+
+    WriteString(func->GetName());
+    Write(static_cast<uint8_t>(func->GetRetType()));
+    if (func->GetRetType() == DataType::PTR) {
+        WritePtrChain(static_cast<PtrFunction *>(func)->GetPtrChain());
+    }
+    Write(static_cast<uint8_t>(func->HasArgs()));
+    Write(static_cast<uint64_t>(func->GetArgsSize()));
+
+    Write(static_cast<uint32_t>(func->GetCalleeSummaries().size()));
+    for (auto &[callee, summary] : func->GetCalleeSummaries()) {
+        WriteString(callee);
+        Write(summary.effects);
+    }
+
+    // Operand table
+    Write(static_cast<uint32_t>(reg_list.size()));
+    for (auto *op : reg_list) {
+        Write(static_cast<uint8_t>(op->GetType()));
+        WriteString(op->GetName());
+        if (op->GetType() == DataType::PTR) {
+            WritePtrChain(static_cast<PtrOperand *>(op)->GetPtrChain());
+        }
+    }
+
+    // Blocks are declared before any instruction so that jumps
+    // can refer to blocks that appear later in the function.
+    Write(static_cast<uint32_t>(func->GetBlockSize()));
+    for (auto *block : func->GetBlocks()) {
+        WriteString(block->GetName());
+        auto *label = block->GetLabel();
+        Write(static_cast<uint8_t>(label != nullptr));
+        if (label) {
+            WriteString(label->GetName());
+        }
+    }
+
+    for (auto *block : func->GetBlocks()) {
+        Write(static_cast<uint32_t>(block->GetInstructionSize()));
+        for (auto *instr : block->GetInstructions()) {
+            WriteInstruction(instr);
+        }
+    }
+
+    // CFG
+    for (auto *block : func->GetBlocks()) {
+        Write(static_cast<uint32_t>(block->GetSuccessorSize()));
+        for (auto *succ : block->GetSuccessors()) {
+            Write(blocks.at(succ));
+        }
+        Write(static_cast<uint32_t>(block->GetPredecessorSize()));
+        for (auto *pred : block->GetPredecessors()) {
+            Write(blocks.at(pred));
+        }
+    }
+
+    // Def-use links. Instructions that are no longer part of the
+    // function are skipped since they can't be referenced on load.
+    for (auto *op : reg_list) {
+        WriteInstrRef(op->GetDef());
+        uint32_t count = 0;
+        for (auto *use : op->GetUses()) {
+            count += ids.contains(use);
+        }
+        Write(count);
+        for (auto *use : op->GetUses()) {
+            if (ids.contains(use)) {
+                Write(ids.at(use));
+            }
+        }
+    }
+}
+
+void IRWriter::WriteInstruction(InstructionBase *instr) {
+    Write(static_cast<uint8_t>(instr->GetOpcode()));
+    WriteOperandRef(instr->GetDest());
+    Write(static_cast<uint32_t>(instr->GetOperandSize()));
+    for (auto *op : instr->GetOperands()) {
+        WriteOperandRef(op);
+    }
+
+    switch (instr->GetOpcode()) {
+    case Opcode::JMP: {
+        auto *jmp = static_cast<JmpInstruction *>(instr);
+        Write(blocks.at(jmp->GetJmpDest()->GetBlock()));
+    } break;
+    case Opcode::BR: {
+        auto *br = static_cast<BranchInstruction *>(instr);
+        Write(blocks.at(br->GetTrueDest()->GetBlock()));
+        Write(blocks.at(br->GetFalseDest()->GetBlock()));
+    } break;
+    case Opcode::CALL: {
+        auto *call = static_cast<CallInstruction *>(instr);
+        WriteString(call->GetFuncName());
+        Write(static_cast<uint8_t>(call->HasDest()));
+    } break;
+    case Opcode::SET: {
+        auto *seti = static_cast<SetInstruction *>(instr);
+        WriteOperandRef(seti->GetShadow());
+        WriteInstrRef(seti->GetGetPair());
+    } break;
+    case Opcode::GET: {
+        // The shadow of a get is only meaningful while the SSA
+        // renaming is in progress, afterwards the dest names it.
+        auto *geti = static_cast<GetInstruction *>(instr);
+        Write(static_cast<uint32_t>(geti->GetSetPairSize()));
+        for (auto *seti : geti->GetSetPairs()) {
+            WriteInstrRef(seti);
+        }
+    } break;
+    default:
+        break;
+    }
+}
+
+void IRWriter::WriteOperandRef(OperandBase *op) {
+    auto tag = GetOperandTag(op);
+    Write(static_cast<uint8_t>(tag));
+    switch (tag) {
+    case OperandTag::REG:
+        Write(regs.at(op));
+        break;
+    case OperandTag::INT:
+        Write(ints.at(static_cast<IntOperand *>(op)->GetValue()));
+        break;
+    case OperandTag::FLOAT:
+        Write(floats.at(std::bit_cast<uint64_t>(
+            static_cast<FloatOperand *>(op)->GetValue())));
+        break;
+    case OperandTag::BOOL:
+        Write(static_cast<uint32_t>(static_cast<BoolOperand *>(op)->GetValue()));
+        break;
+    case OperandTag::LABEL:
+        Write(blocks.at(static_cast<LabelOperand *>(op)->GetBlock()));
+        break;
+    default:
+        break;
+    }
+}
+
+void IRWriter::WriteInstrRef(InstructionBase *instr) {
+    Write(instr && ids.contains(instr) ? ids.at(instr) : none);
+}
+
+class IRReader {
+  public:
+    IRReader(const char *_data, size_t _size) : data(_data), size(_size) {}
+
+    std::unique_ptr<Program> ReadProgram(std::string *stage);
+
+  private:
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+
+    std::vector<ValType::INT> int_pool;
+    std::vector<ValType::FLOAT> float_pool;
+
+    // Per function tables
+    std::vector<std::shared_ptr<OperandBase>> regs;
+    std::vector<InstructionBase *> instrs;
+    std::vector<Block *> blocks;
+
+    template <typename T> T Read() {
+        Check(sizeof(T));
+        T value;
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string ReadString() {
+        auto len = Read<uint32_t>();
+        Check(len);
+        std::string str(data + pos, len);
+        pos += len;
+        return str;
+    }
+
+    void Check(size_t len) const {
+        if (pos + len > size) {
+            throw std::runtime_error("Error loading IR. Truncated input.\n");
+        }
+    }
+
+    template <typename T> T ReadPtrChain(T t) {
+        auto len = Read<uint32_t>();
+        for (uint32_t i = 0; i < len; ++i) {
+            t->AppendPtrChain(static_cast<DataType>(Read<uint8_t>()));
+        }
+        return t;
+    }
+
+    std::unique_ptr<Function> ReadFunction();
+    std::unique_ptr<InstructionBase> ReadInstruction(
+        std::vector<std::pair<SetInstruction *, uint32_t>> &set_pairs,
+        std::vector<std::pair<GetInstruction *, std::vector<uint32_t>>>
+            &get_pairs);
+    OperandBase *ReadOperandRef();
+    std::shared_ptr<OperandBase> ReadDestRef();
+    InstructionBase *GetInstr(uint32_t id) const;
+    Block *GetBlock(uint32_t idx) const;
+};
+
+std::unique_ptr<Program> IRReader::ReadProgram(std::string *stage) {
+    Check(sizeof(magic));
+    if (std::memcmp(data, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("Error loading IR. Invalid magic.\n");
+    }
+    pos += sizeof(magic);
+
+    if (auto v = Read<uint32_t>(); v != version) {
+        throw std::runtime_error(
+            std::format("Error loading IR. Unsupported version {}.\n", v));
+    }
+
+    auto name = ReadString();
+    if (stage) {
+        *stage = name;
+    }
+
+    int_pool.resize(Read<uint32_t>());
+    for (auto &value : int_pool) {
+        value = Read<ValType::INT>();
+    }
+    float_pool.resize(Read<uint32_t>());
+    for (auto &value : float_pool) {
+        value = Read<ValType::FLOAT>();
+    }
+
+    auto program = std::make_unique<Program>();
+    auto nfuncs = Read<uint32_t>();
+    for (uint32_t i = 0; i < nfuncs; ++i) {
+        program->AddFunction(ReadFunction());
+    }
+    return program;
+}
+
+std::unique_ptr<Function> IRReader::ReadFunction() {
+    regs.clear();
+    instrs.clear();
+    blocks.clear();
+
+    std::unique_ptr<Function> func = nullptr;
+    auto name = ReadString();
+    auto ret_type = static_cast<DataType>(Read<uint8_t>());
+    if (ret_type == DataType::PTR) {
+        func = ReadPtrChain(std::make_unique<PtrFunction>(name));
+    } else {
+        func = std::make_unique<Function>(name, ret_type);
+    }
+    func->SetArgs(Read<uint8_t>());
+    func->SetArgsSize(Read<uint64_t>());
+
+    auto nsummaries = Read<uint32_t>();
+    for (uint32_t i = 0; i < nsummaries; ++i) {
+        auto callee = ReadString();
+        func->SetCalleeSummary(callee, {Read<uint8_t>()});
+    }
+
+    // Operand table
+    regs.resize(Read<uint32_t>());
+    for (auto &op : regs) {
+        auto type = static_cast<DataType>(Read<uint8_t>());
+        auto op_name = ReadString();
+        if (type == DataType::PTR) {
+            op = ReadPtrChain(std::make_shared<PtrOperand>(op_name));
+        } else {
+            op = std::make_shared<RegOperand>(type, op_name);
+        }
+    }
+
+    // Blocks
+    auto nblocks = Read<uint32_t>();
+    for (uint32_t i = 0; i < nblocks; ++i) {
+        auto block = std::make_unique<Block>(ReadString());
+        block->SetIndex(i);
+        if (Read<uint8_t>()) {
+            auto label = std::make_unique<LabelOperand>(ReadString());
+            label->SetBlock(block.get());
+            block->SetLabel(std::move(label));
+        }
+        blocks.push_back(block.get());
+        func->AddBlock(std::move(block));
+    }
+
+    // Instructions
+    std::vector<std::pair<SetInstruction *, uint32_t>> set_pairs;
+    std::vector<std::pair<GetInstruction *, std::vector<uint32_t>>> get_pairs;
+    for (auto *block : blocks) {
+        auto ninstrs = Read<uint32_t>();
+        for (uint32_t i = 0; i < ninstrs; ++i) {
+            auto instr = ReadInstruction(set_pairs, get_pairs);
+            instrs.push_back(instr.get());
+            block->AddInstruction(std::move(instr));
+        }
+    }
+
+    for (auto &[seti, id] : set_pairs) {
+        seti->SetGetPair(static_cast<GetInstruction *>(GetInstr(id)));
+    }
+    for (auto &[geti, sets] : get_pairs) {
+        for (auto id : sets) {
+            geti->SetSetPair(static_cast<SetInstruction *>(GetInstr(id)));
+        }
+    }
+
+    // CFG
+    for (auto *block : blocks) {
+        auto nsucc = Read<uint32_t>();
+        for (uint32_t i = 0; i < nsucc; ++i) {
+            block->AddSuccessor(GetBlock(Read<uint32_t>()));
+        }
+        auto npred = Read<uint32_t>();
+        for (uint32_t i = 0; i < npred; ++i) {
+            block->AddPredecessor(GetBlock(Read<uint32_t>()));
+        }
+    }
+
+    // Def-use links
+    for (auto &op : regs) {
+        op->SetDef(GetInstr(Read<uint32_t>()));
+        auto nuses = Read<uint32_t>();
+        for (uint32_t i = 0; i < nuses; ++i) {
+            op->SetUse(GetInstr(Read<uint32_t>()));
+        }
+    }
+
+    return func;
+}
+
+std::unique_ptr<InstructionBase> IRReader::ReadInstruction(
+    std::vector<std::pair<SetInstruction *, uint32_t>> &set_pairs,
+    std::vector<std::pair<GetInstruction *, std::vector<uint32_t>>>
+        &get_pairs) {
+    auto instr = MakeInstruction(static_cast<Opcode>(Read<uint8_t>()));
+
+    if (auto dest = ReadDestRef()) {
+        instr->AddDest(std::move(dest));
+    }
+    auto nops = Read<uint32_t>();
+    for (uint32_t i = 0; i < nops; ++i) {
+        instr->SetOperand(ReadOperandRef());
+    }
+
+    switch (instr->GetOpcode()) {
+    case Opcode::JMP: {
+        auto *jmp = static_cast<JmpInstruction *>(instr.get());
+        jmp->SetJmpDest(GetBlock(Read<uint32_t>())->GetLabel());
+    } break;
+    case Opcode::BR: {
+        auto *br = static_cast<BranchInstruction *>(instr.get());
+        br->SetTrueDest(GetBlock(Read<uint32_t>())->GetLabel());
+        br->SetFalseDest(GetBlock(Read<uint32_t>())->GetLabel());
+    } break;
+    case Opcode::CALL: {
+        auto *call = static_cast<CallInstruction *>(instr.get());
+        call->SetFuncName(ReadString());
+        call->SetRetVal(Read<uint8_t>());
+    } break;
+    case Opcode::SET: {
+        auto *seti = static_cast<SetInstruction *>(instr.get());
+        seti->SetShadow(ReadOperandRef());
+        set_pairs.emplace_back(seti, Read<uint32_t>());
+    } break;
+    case Opcode::GET: {
+        auto *geti = static_cast<GetInstruction *>(instr.get());
+        geti->SetShadow(geti->GetDest());
+        std::vector<uint32_t> sets(Read<uint32_t>());
+        for (auto &id : sets) {
+            id = Read<uint32_t>();
+        }
+        get_pairs.emplace_back(geti, std::move(sets));
+    } break;
+    default:
+        break;
+    }
+
+    return instr;
+}
+
+OperandBase *IRReader::ReadOperandRef() {
+    auto tag = static_cast<OperandTag>(Read<uint8_t>());
+    switch (tag) {
+    case OperandTag::NONE:
+        return nullptr;
+    case OperandTag::REG: {
+        auto idx = Read<uint32_t>();
+        if (idx >= regs.size()) {
+            throw std::runtime_error("Error loading IR. Invalid operand.\n");
+        }
+        return regs[idx].get();
+    }
+    case OperandTag::INT:
+        return IntOperand::GetOperand(int_pool.at(Read<uint32_t>()));
+    case OperandTag::FLOAT:
+        return FloatOperand::GetOperand(float_pool.at(Read<uint32_t>()));
+    case OperandTag::BOOL:
+        return BoolOperand::GetOperand(Read<uint32_t>());
+    case OperandTag::UNDEF:
+        return UndefOperand::GetUndefOperand().get();
+    case OperandTag::VOID:
+        return VoidOperand::GetVoidOperand().get();
+    case OperandTag::LABEL:
+        return GetBlock(Read<uint32_t>())->GetLabel();
+    default:
+        throw std::runtime_error("Error loading IR. Invalid operand tag.\n");
+    }
+}
+
+std::shared_ptr<OperandBase> IRReader::ReadDestRef() {
+    auto tag = static_cast<OperandTag>(Read<uint8_t>());
+    switch (tag) {
+    case OperandTag::NONE:
+        return nullptr;
+    case OperandTag::REG: {
+        auto idx = Read<uint32_t>();
+        if (idx >= regs.size()) {
+            throw std::runtime_error("Error loading IR. Invalid operand.\n");
+        }
+        return regs[idx];
+    }
+    case OperandTag::VOID:
+        return VoidOperand::GetVoidOperand();
+    default:
+        throw std::runtime_error("Error loading IR. Invalid dest operand.\n");
+    }
+}
+
+InstructionBase *IRReader::GetInstr(uint32_t id) const {
+    if (id == none) {
+        return nullptr;
+    }
+    if (id >= instrs.size()) {
+        throw std::runtime_error("Error loading IR. Invalid instruction.\n");
+    }
+    return instrs[id];
+}
+
+Block *IRReader::GetBlock(uint32_t idx) const {
+    if (idx >= blocks.size()) {
+        throw std::runtime_error("Error loading IR. Invalid block.\n");
+    }
+    return blocks[idx];
+}
+
+void WriteIR(Program *program, std::ostream &out, const std::string &stage) {
+    std::vector<Function *> funcs;
+    for (auto &f : *program) {
+        funcs.push_back(f.get());
+    }
+    IRWriter(out).WriteFunctions(funcs, stage);
+}
+
+void WriteIR(Function *func, std::ostream &out, const std::string &stage) {
+    IRWriter(out).WriteFunctions({func}, stage);
+}
+
+void WriteIR(Program *program, const std::string &path,
+             const std::string &stage) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error(
+            std::format("Error writing IR. Unable to open {}.\n", path));
+    }
+    WriteIR(program, out, stage);
+}
+
+std::unique_ptr<Program> LoadIR(const char *data, size_t size,
+                                std::string *stage) {
+    return IRReader(data, size).ReadProgram(stage);
+}
+
+std::unique_ptr<Program> LoadIR(const std::string &path, std::string *stage) {
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(
+            std::format("Error loading IR. Unable to open {}.\n", path));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error(
+            std::format("Error loading IR. Unable to read {}.\n", path));
+    }
+
+    auto size = static_cast<size_t>(st.st_size);
+    auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(
+            std::format("Error loading IR. Unable to map {}.\n", path));
+    }
+
+    try {
+        auto program = LoadIR(static_cast<const char *>(data), size, stage);
+        munmap(data, size);
+        return program;
+    } catch (...) {
+        munmap(data, size);
+        throw;
+    }
+}
+} // namespace sc
@@ -1,39 +1,405 @@
 #include "analyzers/cfg.hpp"
+#include "analyzers/summary_analyzer.hpp"
 #include "bril_parser.hpp"
+#include "compile_cache.hpp"
+#include "compile_server.hpp"
+#include "ir_serializer.hpp"
 #include "program.hpp"
+#include "statistics.hpp"
 #include "transformers/dce_transformer.hpp"
 #include "transformers/transformer.hpp"
 #include "transformers/early_ir_transformer.hpp"
 #include "transformers/cf_transformer.hpp"
+#include "transformers/hoist_alloc_transformer.hpp"
+#include "transformers/inline_transformer.hpp"
+#include "transformers/ipsccp_transformer.hpp"
+#include "transformers/jump_thread_transformer.hpp"
 #include "transformers/ssa_transformer.hpp"
 #include "transformers/dvn_transformer.hpp"
+#include "transformers/dse_transformer.hpp"
+#include "transformers/layout_transformer.hpp"
+#include "transformers/licm_transformer.hpp"
+#include "transformers/osr_transformer.hpp"
+#include "transformers/pre_transformer.hpp"
+#include "transformers/peephole_transformer.hpp"
+#include "transformers/reassociate_transformer.hpp"
+#include "transformers/rle_transformer.hpp"
+#include "transformers/sroa_transformer.hpp"
 #include "transformers/sscp_transformer.hpp"
+#include "transformers/tre_transformer.hpp"
+#include "transformers/unroll_transformer.hpp"
+#include "transformers/unswitch_transformer.hpp"
+#include "transformers/vrp_transformer.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace sc {
 std::unique_ptr<Program> ParseProgram(sjp::Json);
 }
 
+// A stage transforms one function at a time, or the whole program when
+// it has to look across functions.
+struct Pass {
+    std::string name;
+    void (*function)(sc::Function *);
+    void (*program)(sc::Program *) = nullptr;
+};
+
+// Pipeline in the order it is applied. The names are used to record
+// and resume the stage of a serialized IR snapshot.
+static const std::vector<Pass> pipeline = {
+    {"early-ir", sc::ApplyTransformation<sc::EarlyIRTransformer>},
+    {"cfg", sc::BuildCFG},
+    {"cf", sc::ApplyTransformation<sc::CFTransformer>},
+    {"tre", sc::ApplyTransformation<sc::TRETransformer>},
+    {"inline", nullptr, sc::Inline},
+    {"ipsccp", nullptr, sc::PropagateConstants},
+    {"ipa", nullptr, sc::SummarizeCalls},
+    {"sroa", sc::ApplyTransformation<sc::SROATransformer>},
+    {"thread", sc::ApplyTransformation<sc::JumpThreadTransformer>},
+    {"unswitch", sc::ApplyTransformation<sc::UnswitchTransformer>},
+    {"unroll", sc::ApplyTransformation<sc::UnrollTransformer>},
+    {"ssa", sc::ApplyTransformation<sc::SSATransformer>},
+    {"reassociate", sc::ApplyTransformation<sc::ReassociateTransformer>},
+    {"dvn", sc::ApplyTransformation<sc::DVNTransformer>},
+    {"vrp", sc::ApplyTransformation<sc::VRPTransformer>},
+    {"rle", sc::ApplyTransformation<sc::RLETransformer>},
+    {"dse", sc::ApplyTransformation<sc::DSETransformer>},
+    {"pre", sc::ApplyTransformation<sc::PRETransformer>},
+    {"licm", sc::ApplyTransformation<sc::LICMTransformer>},
+    {"hoist-alloc", sc::ApplyTransformation<sc::HoistAllocTransformer>},
+    {"osr", sc::ApplyTransformation<sc::OSRTransformer>},
+    {"peephole", sc::ApplyTransformation<sc::PeepholeTransformer>},
+    {"dce", sc::ApplyTransformation<sc::DCETransformer>},
+    {"layout", sc::ApplyTransformation<sc::LayoutTransformer>},
+    // {"sscp", sc::ApplyTransformation<sc::SSCPTransformer>},
+};
+
+// Position in the pipeline right after the named stage.
+static size_t GetStage(const std::string &name) {
+    if (name == "parse") {
+        return 0;
+    }
+
+    auto it = std::ranges::find(pipeline, name, &Pass::name);
+    if (it == pipeline.end()) {
+        throw std::runtime_error("Unknown pass " + name + ".\n");
+    }
+    return static_cast<size_t>(it - pipeline.begin()) + 1;
+}
+
+// Whole-program stages are skipped, a function compiled on its own has
+// no other function to look at.
+static void Optimize(sc::Function *func, size_t begin = 0,
+                     size_t end = pipeline.size()) {
+    for (size_t i = begin; i < end; ++i) {
+        if (pipeline[i].function) {
+            pipeline[i].function(func);
+        }
+    }
+}
+
+// Stage by stage, every function goes through a stage before the next
+static void Optimize(sc::Program *program, size_t begin = 0,
+                     size_t end = pipeline.size()) {
+    for (size_t i = begin; i < end; ++i) {
+        if (pipeline[i].program) {
+            pipeline[i].program(program);
+            continue;
+        }
+        for (auto &f : *program) {
+            pipeline[i].function(f.get());
+        }
+    }
+}
+
+// Stages run on the whole program before its functions are compiled
+// one at a time
+static size_t GetProgramStagesEnd() {
+    auto it = std::ranges::find_if(pipeline | std::views::reverse,
+                                   [](auto &pass) { return pass.program; });
+    return static_cast<size_t>(pipeline.rend() - it);
+}
+
+// Anything that changes the output for the same input must be part of
+// the cache configuration, this includes the compiler binary itself.
+static std::string GetCacheConfig() {
+    std::string config;
+    for (auto &pass : pipeline) {
+        config += pass.name + ";";
+    }
+    config += std::to_string(sc::UnrollTransformer::GetFactor()) + ";";
+
+    std::error_code ec;
+    auto exe = std::filesystem::canonical("/proc/self/exe", ec);
+    if (!ec) {
+        config += exe.string() + ";" +
+                  std::to_string(std::filesystem::file_size(exe, ec)) + ";" +
+                  std::to_string(std::filesystem::last_write_time(exe, ec)
+                                     .time_since_epoch()
+                                     .count());
+    }
+    return config;
+}
+
+// Optimizes a function from stage begin on and returns its printed form.
+// With a cache the text of a previous compilation is reused when
+// available.
+static std::string Compile(sc::Function *func, sc::CompileCache *cache,
+                           size_t begin = 0) {
+    std::string key;
+    if (cache) {
+        key = cache->GetKey(func);
+        if (auto text = cache->Lookup(key)) {
+            return *text;
+        }
+    }
+
+    Optimize(func, begin);
+    std::stringstream out;
+    func->Dump(out, true);
+
+    if (cache) {
+        cache->Store(key, out.str());
+    }
+    return out.str();
+}
+
 int main(int argc, char *argv[]) {
+    bool stream = false;
+    bool time = false;
+    bool stats = false;
+    bool unroll = false;
+    std::string file;
+    std::string emit_ir;
+    std::string load_ir;
+    std::string emit_after;
+    std::string cache_dir;
+    uintmax_t cache_size = 256;
+    std::string serve;
+    size_t threads = std::thread::hardware_concurrency();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stream") {
+            // Optimize and print every function as soon as it is parsed
+            // instead of holding the whole program in memory.
+            stream = true;
+        } else if (arg == "--emit-ir" && i + 1 < argc) {
+            emit_ir = argv[++i];
+        } else if (arg == "--emit-after" && i + 1 < argc) {
+            emit_after = argv[++i];
+        } else if (arg == "--load-ir" && i + 1 < argc) {
+            load_ir = argv[++i];
+        } else if (arg == "--time") {
+            time = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            // Limit of the cache directory in MiB
+            cache_size = std::stoull(argv[++i]);
+        } else if (arg == "--stats") {
+            stats = true;
+            sc::Statistics::Get().SetEnabled(true);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            // Unix socket path, or - to serve requests on stdin
+            serve = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoull(argv[++i]);
+        } else if (arg == "--unroll" && i + 1 < argc) {
+            // Partial unroll factor, 1 disables partial unrolling
+            sc::UnrollTransformer::SetFactor(std::stoull(argv[++i]));
+            unroll = true;
+        } else {
+            file = arg;
+        }
+    }
+
+    if (stream && (!emit_ir.empty() || !load_ir.empty())) {
+        std::cerr << "--stream can't be combined with IR snapshots.\n";
+        return 1;
+    }
+
+    // The stage only names where a snapshot is taken
+    if (!emit_after.empty() && emit_ir.empty()) {
+        std::cerr << "--emit-after needs --emit-ir.\n";
+        return 1;
+    }
+
+    if (emit_after.empty()) {
+        emit_after = pipeline.back().name;
+    }
+
+    std::ifstream ifs;
+    if (!file.empty()) {
+        ifs.open(file);
+    }
+    std::istream *input = file.empty() ? &std::cin : &ifs;
+
+    // Only the output of the full pipeline starting from source is cached
+    std::unique_ptr<sc::CompileCache> cache = nullptr;
+    if (!cache_dir.empty() && emit_ir.empty() && load_ir.empty()) {
+        cache = std::make_unique<sc::CompileCache>(
+            cache_dir, GetCacheConfig(), cache_size << 20);
+    }
+
+    if (!serve.empty() && serve != "-") {
+        // Passes assert on some malformed programs, which takes down the
+        // whole server. A supervisor keeps a fresh server running, the
+        // clients of the crashed one fall back to compiling locally. A
+        // server that keeps crashing right after it starts isn't restarted
+        // forever.
+        size_t quick_crashes = 0;
+        while (true) {
+            auto start = std::chrono::steady_clock::now();
+            auto pid = fork();
+            if (!pid) {
+                break;
+            }
+            int wstatus;
+            if (pid < 0 || waitpid(pid, &wstatus, 0) < 0) {
+                std::cerr << "Unable to start server.\n";
+                return 1;
+            }
+            if (WIFEXITED(wstatus)) {
+                return WEXITSTATUS(wstatus);
+            }
+            auto uptime = std::chrono::steady_clock::now() - start;
+            quick_crashes =
+                uptime < std::chrono::seconds(1) ? quick_crashes + 1 : 0;
+            if (quick_crashes == 5) {
+                std::cerr << "Server keeps crashing, giving up.\n";
+                return 1;
+            }
+            std::cerr << "Server crashed, restarting.\n";
+        }
+    }
+
+    if (!serve.empty()) {
+        sc::CompileServer server(
+            [&cache](std::istream &request) {
+                std::string output;
+                auto program = sc::BrilParser::ParseProgram(request);
+                auto begin = GetProgramStagesEnd();
+                Optimize(program.get(), 0, begin);
+                for (auto &f : *program) {
+                    output += Compile(f.get(), cache.get(), begin);
+                }
+                return output;
+            },
+            threads, time);
+
+        try {
+            if (serve == "-") {
+                server.Serve(STDIN_FILENO, STDOUT_FILENO);
+            } else {
+                server.Serve(serve);
+            }
+        } catch (const std::exception &e) {
+            // The socket can't be set up, restarting won't help
+            std::cerr << e.what();
+            return 1;
+        }
+        return 0;
+    }
+
+    // Hand plain compilations to a running server when there is one, the
+    // program is compiled in this process if the server can't be reached.
+    // The server compiles with its own options, so a program compiled with
+    // other options stays here.
+    auto *server = std::getenv("SC_SERVER");
+    std::istringstream buffered;
+    if (server && !stream && !stats && !cache && !unroll && emit_ir.empty() &&
+        load_ir.empty()) {
+        std::stringstream text;
+        text << input->rdbuf();
+
+        int status;
+        auto start = std::chrono::steady_clock::now();
+        if (sc::RunClient(server, text.str(), std::cout, std::cerr, status)) {
+            if (time) {
+                std::chrono::duration<double, std::milli> elapsed =
+                    std::chrono::steady_clock::now() - start;
+                std::cerr << "request: " << elapsed.count() << " ms\n";
+            }
+            return status;
+        }
+        buffered.str(text.str());
+        input = &buffered;
+    }
+
+    if (stream) {
+        sc::BrilParser::StreamProgram(
+            *input, [&cache](std::unique_ptr<sc::Function> func) {
+                std::cout << Compile(func.get(), cache.get());
+            });
+        if (stats) {
+            sc::Statistics::Get().Dump();
+        }
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
     std::unique_ptr<sc::Program> program;
-    if (argc < 2) {
-        program = sc::BrilParser::ParseProgram(std::cin);
+    size_t begin = 0;
+    if (!load_ir.empty()) {
+        // Resume the pipeline after the stage recorded in the snapshot
+        std::string stage;
+        program = sc::LoadIR(load_ir, &stage);
+        begin = GetStage(stage);
     } else {
-        std::ifstream ifs(argv[1]);
-        program = sc::BrilParser::ParseProgram(ifs);
-    }
-
-    program =
-        sc::ApplyTransformation<sc::EarlyIRTransformer>(std::move(program));
-    program = sc::BuildCFG(std::move(program));
-    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
-    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
-    program = sc::ApplyTransformation<sc::DVNTransformer>(std::move(program));
-    program = sc::ApplyTransformation<sc::DCETransformer>(std::move(program));
-    // program = sc::ApplyTransformation<sc::SSCPTransformer>(std::move(program));
-    program->Dump();
+        program = sc::BrilParser::ParseProgram(*input);
+    }
+
+    if (time) {
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cerr << (load_ir.empty() ? "parse: " : "load: ")
+                  << elapsed.count() << " ms\n";
+    }
+
+    if (cache) {
+        auto begin = GetProgramStagesEnd();
+        Optimize(program.get(), 0, begin);
+        for (auto &f : *program) {
+            std::cout << Compile(f.get(), cache.get(), begin);
+        }
+        if (stats) {
+            sc::Statistics::Get().Dump();
+        }
+        return 0;
+    }
+
+    auto end = emit_ir.empty() ? pipeline.size() : GetStage(emit_after);
+    if (end < begin) {
+        std::cerr << "Snapshot is already past " << emit_after << ".\n";
+        return 1;
+    }
+
+    Optimize(program.get(), begin, end);
+
+    if (!emit_ir.empty()) {
+        sc::WriteIR(program.get(), emit_ir, emit_after);
+        return 0;
+    }
+
+    program->Dump(std::cout, true);
+    if (stats) {
+        sc::Statistics::Get().Dump();
+    }
 
     return 0;
 }
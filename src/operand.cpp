@@ -2,6 +2,8 @@
 #include "instruction.hpp"
 #include <cassert>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 
 namespace sc {
@@ -85,30 +87,54 @@ std::shared_ptr<OperandBase> PtrOperand::Clone() const {
     return clone;
 }
 
+// The interned immediates are shared by functions parsed and compiled on
+// different threads. Lookups of existing constants, by far the common
+// case, only take a shared lock; pointers stay valid once inserted.
 IntOperand *IntOperand::GetOperand(val_type value) {
     static std::unordered_map<val_type, std::unique_ptr<IntOperand>> store;
-    if (!store.contains(value)) {
-        store.emplace(value, std::unique_ptr<IntOperand>(new IntOperand(
-                                 "_$IK_" + std::to_string(value), value)));
+    static std::shared_mutex mtx;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = store.find(value);
+        if (it != store.end()) {
+            return it->second.get();
+        }
     }
-    return store[value].get();
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    auto &op = store[value];
+    if (op == nullptr) {
+        op = std::unique_ptr<IntOperand>(
+            new IntOperand("_$IK_" + std::to_string(value), value));
+    }
+    return op.get();
 }
 
 FloatOperand *FloatOperand::GetOperand(val_type value) {
     static std::unordered_map<val_type, std::unique_ptr<FloatOperand>> store;
-    if (!store.contains(value)) {
-        store.emplace(value, std::unique_ptr<FloatOperand>(new FloatOperand(
-                                 "_$FK_" + std::to_string(value), value)));
+    static std::shared_mutex mtx;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = store.find(value);
+        if (it != store.end()) {
+            return it->second.get();
+        }
     }
-    return store[value].get();
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    auto &op = store[value];
+    if (op == nullptr) {
+        op = std::unique_ptr<FloatOperand>(
+            new FloatOperand("_$FK_" + std::to_string(value), value));
+    }
+    return op.get();
 }
 
 BoolOperand *BoolOperand::GetOperand(val_type value) {
-    static std::unique_ptr<BoolOperand> store[2];
-    if (store[value] == nullptr) {
-        store[value] = std::unique_ptr<BoolOperand>(
-            new BoolOperand(value ? "true" : "false", value));
-    }
+    // Initialization of a local static is thread safe
+    static std::unique_ptr<BoolOperand> store[2] = {
+        std::unique_ptr<BoolOperand>(new BoolOperand("false", false)),
+        std::unique_ptr<BoolOperand>(new BoolOperand("true", true))};
     return store[value].get();
 }
 
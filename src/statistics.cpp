@@ -0,0 +1,31 @@
+#include "statistics.hpp"
+
+namespace sc {
+Statistics &Statistics::Get() {
+    static Statistics stats;
+    return stats;
+}
+
+void Statistics::Add(const std::string &name, size_t count) {
+    std::lock_guard<std::mutex> lock(mtx);
+    counters[name] += count;
+}
+
+size_t Statistics::GetCount(const std::string &name) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = counters.find(name);
+    return it == counters.end() ? 0 : it->second;
+}
+
+void Statistics::Reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.clear();
+}
+
+void Statistics::Dump(std::ostream &out) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto &[name, count] : counters) {
+        out << name << ": " << count << "\n";
+    }
+}
+} // namespace sc
@@ -205,6 +205,10 @@ void CFTransformer::RemoveUnreachableCFNode() {
     for (auto *blk : func->GetBlocks()) {
         if (!reachable.contains(blk)) {
             remove_blks.push_back(blk->GetIndex());
+            // Reachable successors must not point back to a dead block
+            for (auto *succ : blk->GetSuccessors()) {
+                succ->RemovePredecessor(blk);
+            }
         }
     }
     func->RemoveBlocks(std::move(remove_blks));
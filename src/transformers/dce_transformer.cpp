@@ -59,9 +59,11 @@ void DCETransformer::Mark() {
 }
 
 void DCETransformer::Sweep() {
-    std::vector<size_t> remove_list;
+    // The dead instructions are unlinked from their operands before any
+    // is destroyed, a dead use may follow the dead def of its operand
+    std::vector<std::vector<size_t>> remove_lists(func->GetBlockSize());
     for (auto bi : std::views::iota(0ul, func->GetBlockSize())) {
-        remove_list.clear();
+        auto &remove_list = remove_lists[bi];
         auto *block = func->GetBlock(bi);
 
         for (auto i : std::views::iota(0ul, imarks[bi].size())) {
@@ -82,30 +84,41 @@ void DCETransformer::Sweep() {
                             block->AddInstruction(
                                 std::move(jmp_inst),
                                 block->GetInstructionSize() - 1, true);
+                            break;
                         } else {
                             curr = pdom->GetIndex();
                         }
                     } while (true);
                 } else if (instr->GetOpcode() != Opcode::JMP) {
+                    for (auto *op : instr->GetOperands()) {
+                        op->RemoveUse(instr);
+                    }
                     remove_list.push_back(i);
                 }
             }
         }
+    }
 
-        block->RemoveInstructions(remove_list, true);
+    for (auto bi : std::views::iota(0ul, func->GetBlockSize())) {
+        func->GetBlock(bi)->RemoveInstructions(std::move(remove_lists[bi]));
     }
 }
 
 bool DCETransformer::Critical(InstructionBase *instr) {
     switch (instr->GetOpcode()) {
-    case Opcode::RET:
-    case Opcode::PRINT:
-    case Opcode::CALL:
+    case Opcode::CALL: {
         /*
          * Since Call's can have side-effects
          * The calling function might effect a
          * global storage, or it might print.
+         * Unless its summary says otherwise.
          */
+        auto *summary = func->GetCalleeSummary(
+            static_cast<CallInstruction *>(instr)->GetFuncName());
+        return !summary || summary->HasSideEffects();
+    }
+    case Opcode::RET:
+    case Opcode::PRINT:
     case Opcode::ALLOC:
     case Opcode::FREE:
     case Opcode::STORE:
@@ -0,0 +1,95 @@
+#include "transformers/dse_transformer.hpp"
+#include "opcodes.hpp"
+#include "statistics.hpp"
+#include <set>
+#include <utility>
+#include <vector>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// DSETransformer begin
+void DSETransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    aa.Analyze();
+    mssa.Analyze();
+
+    // Removing a store leaves the accesses of the others as they were,
+    // they are all decided on the same Memory SSA
+    std::vector<std::vector<size_t>> remove(func->GetBlockSize());
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::STORE && IsDead(instr)) {
+#ifdef PRINT_DEBUG
+                instr->Dump(std::cerr << "  Dead: ");
+#endif
+                remove[block->GetIndex()].push_back(instr->GetIndex());
+                ++removed;
+            }
+        }
+    }
+    for (auto *block : func->GetBlocks()) {
+        block->RemoveInstructions(std::move(remove[block->GetIndex()]), true);
+    }
+
+    Statistics::Get().Add("dse.stores", removed);
+}
+
+bool DSETransformer::IsDead(InstructionBase *store) const {
+    auto *access = mssa.GetAccess(store);
+    if (!access->defining) {
+        // Unreachable
+        return false;
+    }
+
+    auto *ptr = store->GetOperand(0);
+    // Accesses reached with the memory of the store, and whether a phi
+    // was crossed on the way
+    std::vector<std::pair<MemoryAccess *, bool>> worklist;
+    std::set<std::pair<MemoryAccess *, bool>> visited;
+    for (auto *user : access->users) {
+        worklist.emplace_back(user, false);
+    }
+
+    while (!worklist.empty()) {
+        auto [user, crossed] = worklist.back();
+        worklist.pop_back();
+        if (!visited.emplace(user, crossed).second) {
+            continue;
+        }
+
+        if (user->kind == MemoryAccess::Kind::PHI) {
+            for (auto *next : user->users) {
+                worklist.emplace_back(next, true);
+            }
+            continue;
+        }
+
+        auto *instr = user->instr;
+        if (instr->GetOpcode() == Opcode::LOAD) {
+            auto *p = instr->GetOperand(0);
+            if (crossed ? aa.MayShareObject(p, ptr) : aa.MayAlias(p, ptr)) {
+                return false;
+            }
+        } else if (aa.MayRead(instr, ptr)) {
+            return false;
+        }
+
+        if (user->kind != MemoryAccess::Kind::DEF ||
+            (!crossed && instr->GetOpcode() == Opcode::STORE &&
+             aa.MustAlias(instr->GetOperand(0), ptr))) {
+            // Overwritten
+            continue;
+        }
+        for (auto *next : user->users) {
+            worklist.emplace_back(next, crossed);
+        }
+    }
+    return true;
+}
+// DSETransformer end
+} // namespace sc
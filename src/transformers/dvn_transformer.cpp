@@ -80,10 +80,14 @@ void DVNTransformer::DVN(Block *block) {
 #endif
                     }
                 }
+            } else if (opcode == Opcode::CALL && IsPureCall(instr)) {
+                ProcessCall(static_cast<CallInstruction *>(instr), i);
             } else if (opcode == Opcode::CALL || opcode == Opcode::UNDEF ||
-                       opcode == Opcode::ALLOC || opcode == Opcode::GETARG) {
+                       opcode == Opcode::ALLOC || opcode == Opcode::GETARG ||
+                       opcode == Opcode::LOAD) {
                 /*
-                 * Call Instruction can have side-effect
+                 * Call Instruction can have side-effect, and a load may
+                 * read a value stored after the previous load
                  */
 
                 // Need to set the value number for the dest
@@ -155,6 +159,30 @@ void DVNTransformer::Process(InstructionBase *instr, size_t idx) {
     }
 }
 
+bool DVNTransformer::IsPureCall(InstructionBase *instr) const {
+    auto *summary = func->GetCalleeSummary(
+        static_cast<CallInstruction *>(instr)->GetFuncName());
+    return summary && summary->IsPure();
+}
+
+void DVNTransformer::ProcessCall(CallInstruction *call, size_t idx) {
+    // A pure call is an expression of its arguments
+    auto key = "@" + call->GetFuncName();
+    for (auto *op : call->GetOperands()) {
+        key += " " + op->GetName();
+    }
+    auto *dest = call->GetDest();
+
+    if (auto *vn = vt.Get(key)) {
+        vt.Insert(dest->GetName(), vn);
+        ReplaceUses(dest, vn);
+        MarkForRemoval(call->GetBlock(), idx);
+    } else {
+        vt.Insert(dest->GetName(), dest);
+        vt.Insert(key, dest);
+    }
+}
+
 bool DVNTransformer::IsUselessOrRedundant(GetInstruction *geti,
                                           std::string &key) {
     std::vector<std::string> keys(func->GetBlockSize());
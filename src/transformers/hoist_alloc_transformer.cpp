@@ -0,0 +1,149 @@
+#include "transformers/hoist_alloc_transformer.hpp"
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "analyzers/induction_analyzer.hpp"
+#include "opcodes.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// HoistAllocTransformer begin
+void HoistAllocTransformer::Transform() {
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    for (auto *loop : loops->GetLoopsInnermostFirst()) {
+        Hoist(loop);
+    }
+
+    Statistics::Get().Add("hoist-alloc.hoisted", hoisted);
+    if (Statistics::Get().IsEnabled()) {
+        Account();
+    }
+}
+
+void HoistAllocTransformer::Account() {
+    lifetimes.Analyze();
+    AliasAnalyzer aa(func);
+    aa.Analyze();
+
+    size_t sites = 0;
+    size_t freed = 0;
+    size_t leaked = 0;
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() != Opcode::ALLOC) {
+                continue;
+            }
+
+            ++sites;
+            if (lifetimes.IsFreedInFunction(instr)) {
+                ++freed;
+            } else if (!aa.IsEscaped(instr) && !aa.IsReturned(instr)) {
+#ifdef PRINT_DEBUG
+                instr->Dump(std::cerr << "  Leaks: ");
+#endif
+                ++leaked;
+            }
+        }
+    }
+
+    Statistics::Get().Add("alloc.sites", sites);
+    Statistics::Get().Add("alloc.freed", freed);
+    Statistics::Get().Add("alloc.leaked", leaked);
+}
+
+void HoistAllocTransformer::Hoist(Loop *loop) {
+    auto *preheader = loop->GetPreheader();
+    if (!preheader || loop->GetExits().empty() ||
+        std::ranges::any_of(loop->GetExits(), [loop](Block *exit) {
+            return std::ranges::any_of(
+                exit->GetPredecessors(),
+                [loop](Block *pred) { return !loop->Contains(pred); });
+        })) {
+        return;
+    }
+
+    // The allocations hoisted from inner loops are in their preheaders
+    lifetimes.Analyze();
+    std::vector<InstructionBase *> allocs;
+    for (auto *block : loop->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::ALLOC && CanHoist(loop, instr)) {
+                allocs.push_back(instr);
+            }
+        }
+    }
+
+    for (auto *alloc : allocs) {
+#ifdef PRINT_DEBUG
+        alloc->Dump(std::cerr << "  Hoisting: ");
+#endif
+        std::map<Block *, std::vector<size_t>> remove;
+        for (auto *instr : lifetimes.GetFrees(alloc)) {
+            if (loop->Contains(instr->GetBlock())) {
+                remove[instr->GetBlock()].push_back(instr->GetIndex());
+            }
+        }
+        for (auto &[block, indexes] : remove) {
+            std::ranges::sort(indexes);
+            block->RemoveInstructions(std::move(indexes), true);
+        }
+
+        auto *block = alloc->GetBlock();
+        preheader->InsertInstruction(
+            block->ReleaseInstruction(alloc->GetIndex()),
+            preheader->GetInstructionSize() - 1);
+
+        // After the gets of the exit
+        for (auto *exit : loop->GetExits()) {
+            size_t idx = 0;
+            while (idx < exit->GetInstructionSize() &&
+                   exit->GetInstruction(idx)->GetOpcode() == Opcode::GET) {
+                ++idx;
+            }
+            auto free_instr = std::make_unique<FreeInstruction>();
+            SetOperandAndUse(free_instr.get(), alloc->GetDest());
+            exit->InsertInstruction(std::move(free_instr), idx);
+        }
+        ++hoisted;
+    }
+}
+
+bool HoistAllocTransformer::CanHoist(Loop *loop, InstructionBase *alloc) {
+    // Executed on every iteration, so the loop doesn't allocate more
+    // than before
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+    auto *block = alloc->GetBlock();
+    return InductionAnalyzer::IsRegionConstant(loop, alloc->GetOperand(0)) &&
+           std::ranges::all_of(loop->GetLatches(),
+                               [dom, block](Block *latch) {
+                                   return dom->Dominates(block, latch);
+                               }) &&
+           lifetimes.IsFreedInIteration(alloc, loop) &&
+           IsValidSize(loop, alloc);
+}
+
+bool HoistAllocTransformer::IsValidSize(Loop *loop, InstructionBase *alloc) {
+    // The loop allocates before it can be left
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+    auto *block = alloc->GetBlock();
+    if (std::ranges::all_of(loop->GetExits(), [dom, block](Block *exit) {
+            return dom->Dominates(block, exit);
+        })) {
+        return true;
+    }
+
+    if (!ranges) {
+        ranges = std::make_unique<RangeAnalyzer>(func);
+        ranges->Analyze();
+    }
+    auto range = ranges->GetRange(alloc->GetOperand(0), loop->GetPreheader());
+    return range && range->lo >= 1;
+}
+// HoistAllocTransformer end
+} // namespace sc
@@ -0,0 +1,211 @@
+#include "transformers/inline_transformer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include "transformers/cf_transformer.hpp"
+#include <format>
+#include <utility>
+#include <vector>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// InlineTransformer begin
+void InlineTransformer::Transform() {
+    cg.Analyze();
+    for (auto &f : *program) {
+        sizes[f.get()] = GetSize(f.get());
+    }
+
+    for (auto &scc : cg.GetSCCs()) {
+        for (auto *func : scc) {
+            InlineCalls(func);
+        }
+    }
+
+    Statistics::Get().Add("inline.calls", inlined);
+}
+
+void InlineTransformer::InlineCalls(Function *func) {
+    // The calls of the inlined code were already considered when
+    // inlining into the callee
+    std::vector<CallInstruction *> calls;
+    for (auto *call : cg.GetCalls(func)) {
+        auto *callee = cg.GetFunction(call->GetFuncName());
+        // Recursive calls, and callees whose entry is a loop header
+        // where the arguments would be copied on every iteration
+        if (callee && cg.GetSCCIndex(callee) != cg.GetSCCIndex(func) &&
+            !callee->GetBlock(0)->GetPredecessorSize() &&
+            call->GetOperandSize() == callee->GetArgsSize() &&
+            (!call->HasDest() || callee->GetRetType() != DataType::VOID)) {
+            calls.push_back(call);
+        }
+    }
+    if (calls.empty()) {
+        return;
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+
+    // Loop depths before the CFG changes
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    std::vector<size_t> depths;
+    for (auto *call : calls) {
+        depths.push_back(loops->GetLoopDepth(call->GetBlock()));
+    }
+
+    bool changed = false;
+    for (auto i : std::views::iota(0ul, calls.size())) {
+        auto *callee = cg.GetFunction(calls[i]->GetFuncName());
+        auto limit = depths[i] ? max_size * loop_factor : max_size;
+        if (sizes[callee] > limit ||
+            sizes[func] + sizes[callee] > max_caller_size) {
+            continue;
+        }
+
+#ifdef PRINT_DEBUG
+        std::cerr << "  Inlining: " << callee->GetName() << "\n";
+#endif
+        Inline(func, calls[i], callee);
+        sizes[func] += sizes[callee];
+        changed = true;
+        ++inlined;
+    }
+
+    if (changed) {
+        // Merges the blocks around the inlined code
+        func->InvalidateAnalyses();
+        ApplyTransformation<CFTransformer>(func);
+    }
+}
+
+void InlineTransformer::Inline(Function *func, CallInstruction *call,
+                               Function *callee) {
+    auto *block = call->GetBlock();
+    auto idx = call->GetIndex();
+    auto prefix = std::format("__sc_in{}_", count);
+
+    // The instructions after the call continue in a new block
+    auto name = std::format("__sc_in{}.ret", count++);
+    auto new_block = std::make_unique<Block>(name);
+    auto label = std::make_unique<LabelOperand>(name);
+    label->SetBlock(new_block.get());
+    new_block->SetLabel(std::move(label));
+    auto *rest = new_block.get();
+
+    while (block->GetInstructionSize() > idx + 1) {
+        rest->AddInstruction(block->ReleaseInstruction(idx + 1));
+    }
+    for (auto *succ : block->GetSuccessors()) {
+        rest->AddSuccessor(succ);
+        succ->RemovePredecessor(block);
+        succ->AddPredecessor(rest);
+    }
+    while (block->GetSuccessorSize()) {
+        block->RemoveSuccessor(block->GetSuccessorSize() - 1);
+    }
+    func->InsertBlock(std::move(new_block), block->GetIndex() + 1);
+
+    std::vector<Block *> blocks;
+    for (auto *b : callee->GetBlocks()) {
+        blocks.push_back(b);
+    }
+    auto clones = CloneBlocks(func, blocks, prefix, block->GetIndex() + 1);
+
+    // Every variable of the callee gets a fresh one in the caller,
+    // immediates are shared by all functions
+    std::unordered_map<OperandBase *, std::shared_ptr<OperandBase>> vars;
+    for (auto *b : blocks) {
+        for (auto *instr : b->GetInstructions()) {
+            auto *dest = instr->GetDest();
+            if (instr->HasDest() && !vars.contains(dest)) {
+                auto var = dest->Clone();
+                var->SetName(prefix + dest->GetName());
+                vars[dest] = std::move(var);
+            }
+        }
+    }
+
+    for (auto *b : blocks) {
+        auto *clone = clones[b];
+        for (auto *instr : clone->GetInstructions()) {
+            if (instr->HasDest()) {
+                instr->AddDest(vars.at(instr->GetDest()));
+            }
+            for (auto i : std::views::iota(0ul, instr->GetOperandSize())) {
+                auto it = vars.find(instr->GetOperand(i));
+                if (it != vars.end()) {
+                    instr->SetOperand(it->second.get(), i);
+                }
+            }
+        }
+    }
+
+    // Arguments are copied into the parameters
+    auto *entry = clones[callee->GetBlock(0)];
+    for (auto i : std::views::iota(0ul, callee->GetArgsSize())) {
+        auto *arg = entry->GetInstruction(i);
+        assert(arg->GetOpcode() == Opcode::GETARG);
+        auto id_instr = std::make_unique<IdInstruction>();
+        id_instr->AddDest(arg->CopyDest());
+        id_instr->SetOperand(call->GetOperand(i));
+        entry->AddInstruction(std::move(id_instr), i);
+    }
+
+    // and the returned value into the destination of the call
+    for (auto *b : blocks) {
+        auto *clone = clones[b];
+        size_t i = 0;
+        while (i < clone->GetInstructionSize() &&
+               clone->GetInstruction(i)->GetOpcode() != Opcode::RET) {
+            ++i;
+        }
+        if (i == clone->GetInstructionSize()) {
+            continue;
+        }
+
+        // Anything after the ret is unreachable
+        while (clone->GetInstructionSize() > i + 1) {
+            clone->RemoveInstruction(clone->GetInstructionSize() - 1);
+        }
+        auto *ret = LAST_INSTR(clone);
+
+        if (call->HasDest()) {
+            auto id_instr = std::make_unique<IdInstruction>();
+            id_instr->AddDest(call->CopyDest());
+            id_instr->SetOperand(ret->GetOperand(0));
+            clone->InsertInstruction(std::move(id_instr),
+                                     clone->GetInstructionSize() - 1);
+        }
+        ReplaceWithJmp(clone, rest);
+    }
+
+    // The call jumps to the inlined entry
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(entry->GetLabel());
+    block->AddInstruction(std::move(jmp_instr), idx);
+    block->AddSuccessor(entry);
+    entry->AddPredecessor(block);
+}
+
+size_t InlineTransformer::GetSize(Function *func) {
+    size_t size = 0;
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            size += instr->GetOpcode() != Opcode::GETARG;
+        }
+    }
+    return size;
+}
+
+void Inline(Program *program) {
+    InlineTransformer t(program);
+    t.Transform();
+}
+// InlineTransformer end
+} // namespace sc
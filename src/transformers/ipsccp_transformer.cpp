@@ -0,0 +1,471 @@
+#include "transformers/ipsccp_transformer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include "transformers/cf_transformer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <ranges>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// IPSCCPTransformer begin
+void IPSCCPTransformer::Transform() {
+    Analyze();
+    for (size_t round = 0; round < max_rounds && Specialize(); ++round) {
+        Analyze();
+    }
+
+    for (auto &f : *program) {
+        if (Rewrite(f.get())) {
+            // Removes the blocks the branches no longer reach
+            f->InvalidateAnalyses();
+            ApplyTransformation<CFTransformer>(f.get());
+        }
+    }
+
+    Statistics::Get().Add("ipsccp.constants", constants);
+    Statistics::Get().Add("ipsccp.branches", branches);
+    Statistics::Get().Add("ipsccp.specialized", specialized);
+}
+
+void IPSCCPTransformer::Analyze() {
+    cg.Analyze();
+    callers.clear();
+    args.clear();
+    rets.clear();
+    call_args.clear();
+    values.clear();
+    executable.clear();
+
+    for (auto &f : *program) {
+        for (auto *call : cg.GetCalls(f.get())) {
+            if (auto *callee = cg.GetFunction(call->GetFuncName())) {
+                callers[callee].emplace_back(f.get(), call);
+            }
+        }
+    }
+
+    // Functions nobody calls are entry points with unknown arguments
+    for (auto *f : cg.GetTopDownOrder()) {
+        auto type = callers[f].empty() || f->GetName() == "main"
+                        ? LVT::INDETERMINABLE
+                        : LVT::UNKNOWN;
+        args[f] = std::vector<Value>(f->GetArgsSize(), {type});
+        rets[f] = {};
+        Enqueue(f);
+    }
+
+    while (!worklist.empty()) {
+        auto *f = worklist.front();
+        worklist.pop_front();
+        queued.erase(f);
+        Propagate(f);
+    }
+}
+
+void IPSCCPTransformer::Enqueue(Function *func) {
+    if (queued.insert(func).second) {
+        worklist.push_back(func);
+    }
+}
+
+void IPSCCPTransformer::Propagate(Function *func) {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+
+    // The previous results of the function are computed again
+    for (auto *block : func->GetBlocks()) {
+        executable.erase(block);
+        for (auto *instr : block->GetInstructions()) {
+            values.erase(instr);
+        }
+    }
+    for (auto *call : cg.GetCalls(func)) {
+        call_args.erase(call);
+    }
+
+    auto *entry = func->GetBlock(0);
+    std::unordered_map<Block *, State> in{{entry, {}}};
+    std::vector<Block *> blocks{entry};
+    std::unordered_set<Block *> pending{entry};
+    executable.insert(entry);
+    Value ret;
+
+    while (!blocks.empty()) {
+        auto *block = blocks.back();
+        blocks.pop_back();
+        pending.erase(block);
+
+        auto state = in[block];
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::CALL) {
+                auto &vals = call_args[static_cast<CallInstruction *>(instr)];
+                vals.clear();
+                for (auto *op : instr->GetOperands()) {
+                    vals.push_back(Lookup(state, op));
+                }
+            } else if (instr->GetOpcode() == Opcode::RET &&
+                       instr->GetOperandSize()) {
+                ret = Meet(ret, Lookup(state, instr->GetOperand(0)));
+            }
+
+            if (instr->HasDest()) {
+                auto value = instr->GetOpcode() == Opcode::GETARG
+                                 ? args[func][instr->GetIndex()]
+                                 : Evaluate(instr, state);
+                state[instr->GetDest()] = value;
+                values[instr] = value;
+            }
+        }
+
+        // Only the edges a branch may take are executable
+        std::vector<Block *> targets;
+        auto *last = block->GetInstructionSize() ? LAST_INSTR(block) : nullptr;
+        if (last && last->GetOpcode() == Opcode::BR) {
+            auto *br = static_cast<BranchInstruction *>(last);
+            auto cond = Lookup(state, br->GetOperand(0));
+            values[br] = cond;
+            if (cond.type == LVT::CONSTANT) {
+                auto taken = static_cast<BoolOperand *>(cond.constant)->GetValue();
+                targets.push_back(taken ? br->GetTrueDest()->GetBlock()
+                                        : br->GetFalseDest()->GetBlock());
+            } else if (cond.type == LVT::INDETERMINABLE) {
+                targets.push_back(br->GetTrueDest()->GetBlock());
+                targets.push_back(br->GetFalseDest()->GetBlock());
+            }
+        } else if (!last || last->GetOpcode() != Opcode::RET) {
+            for (auto *succ : block->GetSuccessors()) {
+                targets.push_back(succ);
+            }
+        }
+
+        for (auto *succ : targets) {
+            bool changed = executable.insert(succ).second;
+            if (changed) {
+                in[succ] = state;
+            } else {
+                auto &succ_state = in[succ];
+                for (auto &[var, value] : state) {
+                    auto old = Lookup(succ_state, var);
+                    auto merged = Meet(old, value);
+                    if (merged != old) {
+                        succ_state[var] = merged;
+                        changed = true;
+                    }
+                }
+            }
+
+            if (changed && pending.insert(succ).second) {
+                blocks.push_back(succ);
+            }
+        }
+    }
+
+    // The values only go down the lattice, so that the propagation ends
+    if (auto value = Meet(rets[func], ret); value != rets[func]) {
+        rets[func] = value;
+        for (auto &[caller, call] : callers[func]) {
+            Enqueue(caller);
+        }
+    }
+
+    for (auto *callee : cg.GetCallees(func)) {
+        std::vector<Value> meet(callee->GetArgsSize());
+        for (auto &[caller, call] : callers[callee]) {
+            auto it = call_args.find(call);
+            if (it == call_args.end()) {
+                continue;
+            }
+            for (auto k : std::views::iota(0ul, meet.size())) {
+                meet[k] = k < it->second.size()
+                              ? Meet(meet[k], it->second[k])
+                              : Value{LVT::INDETERMINABLE};
+            }
+        }
+
+        auto &callee_args = args[callee];
+        for (auto k : std::views::iota(0ul, meet.size())) {
+            meet[k] = Meet(callee_args[k], meet[k]);
+        }
+        if (meet != callee_args) {
+            callee_args = std::move(meet);
+            Enqueue(callee);
+        }
+    }
+}
+
+IPSCCPTransformer::Value
+IPSCCPTransformer::Evaluate(InstructionBase *instr, const State &state) const {
+    switch (instr->GetOpcode()) {
+    case Opcode::CONST:
+        return {LVT::CONSTANT, instr->GetOperand(0)};
+    case Opcode::ID:
+        return Lookup(state, instr->GetOperand(0));
+    case Opcode::CALL: {
+        auto *callee = cg.GetFunction(
+            static_cast<CallInstruction *>(instr)->GetFuncName());
+        if (!callee || instr->GetOperandSize() != callee->GetArgsSize()) {
+            return {LVT::INDETERMINABLE};
+        }
+        return rets.at(callee);
+    }
+    case Opcode::ADD:
+    case Opcode::MUL:
+    case Opcode::SUB:
+    case Opcode::DIV:
+    case Opcode::EQ:
+    case Opcode::LT:
+    case Opcode::GT:
+    case Opcode::LE:
+    case Opcode::GE:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::NOT:
+    case Opcode::FADD:
+    case Opcode::FMUL:
+    case Opcode::FSUB:
+    case Opcode::FDIV:
+    case Opcode::FEQ:
+    case Opcode::FLT:
+    case Opcode::FLE:
+    case Opcode::FGT:
+    case Opcode::FGE: {
+        std::vector<OperandBase *> ops;
+        bool unknown = false;
+        for (auto *op : instr->GetOperands()) {
+            auto value = Lookup(state, op);
+            if (value.type == LVT::INDETERMINABLE) {
+                return value;
+            }
+            unknown |= value.type == LVT::UNKNOWN;
+            ops.push_back(value.constant);
+        }
+        if (unknown) {
+            return {};
+        }
+
+        auto *constant = Fold(instr->GetOpcode(), ops);
+        return constant ? Value{LVT::CONSTANT, constant}
+                        : Value{LVT::INDETERMINABLE};
+    }
+    default:
+        return {LVT::INDETERMINABLE};
+    }
+}
+
+IPSCCPTransformer::Value IPSCCPTransformer::Lookup(const State &state,
+                                                   OperandBase *op) {
+    auto it = state.find(op);
+    return it == state.end() ? Value{} : it->second;
+}
+
+IPSCCPTransformer::Value IPSCCPTransformer::Meet(const Value &a,
+                                                 const Value &b) {
+    if (a.type == LVT::UNKNOWN) {
+        return b;
+    }
+    if (b.type == LVT::UNKNOWN || a == b) {
+        return a;
+    }
+    return {LVT::INDETERMINABLE};
+}
+
+OperandBase *IPSCCPTransformer::Fold(Opcode opcode,
+                                     const std::vector<OperandBase *> &ops) {
+    auto ival = [&ops](size_t i) {
+        return static_cast<IntOperand *>(ops[i])->GetValue();
+    };
+    auto fval = [&ops](size_t i) {
+        return static_cast<FloatOperand *>(ops[i])->GetValue();
+    };
+    auto bval = [&ops](size_t i) {
+        return static_cast<BoolOperand *>(ops[i])->GetValue();
+    };
+    // Integers wrap around like in the reference interpreter
+    auto wrap = [](uint64_t value) {
+        return IntOperand::GetOperand(static_cast<ValType::INT>(value));
+    };
+    auto uval = [&ival](size_t i) { return static_cast<uint64_t>(ival(i)); };
+
+    switch (opcode) {
+    case Opcode::ADD:
+        return wrap(uval(0) + uval(1));
+    case Opcode::MUL:
+        return wrap(uval(0) * uval(1));
+    case Opcode::SUB:
+        return wrap(uval(0) - uval(1));
+    case Opcode::DIV:
+        // The division traps at run time
+        if (ival(1) == 0 ||
+            (ival(0) == std::numeric_limits<ValType::INT>::min() &&
+             ival(1) == -1)) {
+            return nullptr;
+        }
+        return IntOperand::GetOperand(ival(0) / ival(1));
+    case Opcode::EQ:
+        return BoolOperand::GetOperand(ival(0) == ival(1));
+    case Opcode::LT:
+        return BoolOperand::GetOperand(ival(0) < ival(1));
+    case Opcode::GT:
+        return BoolOperand::GetOperand(ival(0) > ival(1));
+    case Opcode::LE:
+        return BoolOperand::GetOperand(ival(0) <= ival(1));
+    case Opcode::GE:
+        return BoolOperand::GetOperand(ival(0) >= ival(1));
+    case Opcode::AND:
+        return BoolOperand::GetOperand(bval(0) && bval(1));
+    case Opcode::OR:
+        return BoolOperand::GetOperand(bval(0) || bval(1));
+    case Opcode::NOT:
+        return BoolOperand::GetOperand(!bval(0));
+    case Opcode::FADD:
+        return FloatOperand::GetOperand(fval(0) + fval(1));
+    case Opcode::FMUL:
+        return FloatOperand::GetOperand(fval(0) * fval(1));
+    case Opcode::FSUB:
+        return FloatOperand::GetOperand(fval(0) - fval(1));
+    case Opcode::FDIV:
+        return FloatOperand::GetOperand(fval(0) / fval(1));
+    case Opcode::FEQ:
+        return BoolOperand::GetOperand(fval(0) == fval(1));
+    case Opcode::FLT:
+        return BoolOperand::GetOperand(fval(0) < fval(1));
+    case Opcode::FLE:
+        return BoolOperand::GetOperand(fval(0) <= fval(1));
+    case Opcode::FGT:
+        return BoolOperand::GetOperand(fval(0) > fval(1));
+    case Opcode::FGE:
+        return BoolOperand::GetOperand(fval(0) >= fval(1));
+    default:
+        return nullptr;
+    }
+}
+
+bool IPSCCPTransformer::Specialize() {
+    auto size = [](Function *func) {
+        size_t size = 0;
+        for (auto *block : func->GetBlocks()) {
+            size += block->GetInstructionSize();
+        }
+        return size;
+    };
+
+    // Copies are appended to the program
+    std::vector<Function *> funcs;
+    for (auto &f : *program) {
+        funcs.push_back(f.get());
+    }
+
+    bool changed = false;
+    for (auto *func : funcs) {
+        for (auto *call : cg.GetCalls(func)) {
+            auto *callee = cg.GetFunction(call->GetFuncName());
+            auto it = call_args.find(call);
+            if (!callee || it == call_args.end() ||
+                call->GetOperandSize() != callee->GetArgsSize() ||
+                cg.IsRecursive(callee) || size(callee) > max_size) {
+                continue;
+            }
+
+            // Constants the other calls don't agree on
+            std::vector<OperandBase *> key(callee->GetArgsSize());
+            for (auto k : std::views::iota(0ul, key.size())) {
+                if (it->second[k].type == LVT::CONSTANT &&
+                    args[callee][k].type != LVT::CONSTANT) {
+                    key[k] = it->second[k].constant;
+                }
+            }
+            if (std::ranges::all_of(key, [](auto *c) { return !c; })) {
+                continue;
+            }
+
+            auto spec = specs.find({callee, key});
+            if (spec == specs.end()) {
+                if (clones[callee] == max_clones) {
+                    continue;
+                }
+                ++clones[callee];
+                auto clone = CloneFunction(
+                    callee,
+                    std::format("__sc_sp{}_{}", count++, callee->GetName()));
+                spec = specs.emplace(std::make_pair(callee, key), clone.get())
+                           .first;
+                program->AddFunction(std::move(clone));
+            }
+
+#ifdef PRINT_DEBUG
+            std::cerr << "  Specializing call of " << callee->GetName()
+                      << " in " << func->GetName() << " to "
+                      << spec->second->GetName() << "\n";
+#endif
+            call->SetFuncName(spec->second->GetName());
+            ++specialized;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool IPSCCPTransformer::Rewrite(Function *func) {
+    bool changed = false;
+    for (auto *block : func->GetBlocks()) {
+        if (!executable.contains(block)) {
+            continue;
+        }
+
+        for (size_t i = 0; i < block->GetInstructionSize(); ++i) {
+            auto *instr = block->GetInstruction(i);
+            auto it = values.find(instr);
+            if (!instr->HasDest() || it == values.end() ||
+                it->second.type != LVT::CONSTANT ||
+                instr->GetOpcode() == Opcode::CONST) {
+                continue;
+            }
+
+            auto const_instr = std::make_unique<ConstInstruction>();
+            const_instr->AddDest(instr->CopyDest());
+            const_instr->SetOperand(it->second.constant);
+
+            // Arguments stay in place and calls may have side effects,
+            // the constant is assigned after them
+            if (instr->GetOpcode() == Opcode::GETARG) {
+                block->InsertInstruction(std::move(const_instr),
+                                         func->GetArgsSize());
+            } else if (instr->GetOpcode() == Opcode::CALL) {
+                block->InsertInstruction(std::move(const_instr), ++i);
+            } else {
+                block->AddInstruction(std::move(const_instr), i);
+            }
+            ++constants;
+            changed = true;
+        }
+
+        auto *last = block->GetInstructionSize() ? LAST_INSTR(block) : nullptr;
+        auto cond = last ? values.find(last) : values.end();
+        if (cond != values.end() && last->GetOpcode() == Opcode::BR &&
+            cond->second.type == LVT::CONSTANT) {
+            auto *br = static_cast<BranchInstruction *>(last);
+            auto taken =
+                static_cast<BoolOperand *>(cond->second.constant)->GetValue();
+            ReplaceWithJmp(block, taken ? br->GetTrueDest()->GetBlock()
+                                        : br->GetFalseDest()->GetBlock());
+            ++branches;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void PropagateConstants(Program *program) {
+    IPSCCPTransformer t(program);
+    t.Transform();
+}
+// IPSCCPTransformer end
+} // namespace sc
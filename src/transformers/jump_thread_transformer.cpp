@@ -0,0 +1,206 @@
+#include "transformers/jump_thread_transformer.hpp"
+#include "statistics.hpp"
+#include "transformers/cf_transformer.hpp"
+#include "transformers/ipsccp_transformer.hpp"
+#include <string>
+#include <vector>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+// JumpThreadTransformer begin
+void JumpThreadTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    // The CFG changes with every threaded block, so one block is threaded
+    // at a time with the dominators of the current CFG
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        dom = func->GetAnalysis<DominatorAnalyzer>();
+
+        std::vector<Block *> blocks;
+        for (auto *block : func->GetBlocks()) {
+            blocks.push_back(block);
+        }
+        for (auto *block : blocks) {
+            if (Thread(block)) {
+                func->InvalidateAnalyses();
+                changed = true;
+                break;
+            }
+        }
+    }
+
+    Statistics::Get().Add("thread.edges", edges);
+    Statistics::Get().Add("thread.copies", copies);
+
+    // Merges the copies and removes the blocks left unreachable
+    if (edges) {
+        ApplyTransformation<CFTransformer>(func);
+    }
+}
+
+bool JumpThreadTransformer::Thread(Block *block) {
+    auto *last = LAST_INSTR(block);
+    auto size = block->GetInstructionSize();
+    if (last->GetOpcode() != Opcode::BR || size > max_size) {
+        return false;
+    }
+
+    auto *br = static_cast<BranchInstruction *>(last);
+    auto *true_blk = br->GetTrueDest()->GetBlock();
+    auto *false_blk = br->GetFalseDest()->GetBlock();
+    if (true_blk == false_blk) {
+        return false;
+    }
+
+    if (!block->GetPredecessorSize()) {
+        return false;
+    }
+
+    std::vector<Block *> preds;
+    for (auto *pred : block->GetPredecessors()) {
+        if (dom->Dominates(block, pred)) {
+            // Loop header
+            return false;
+        }
+        preds.push_back(pred);
+    }
+
+    std::vector<Block *> to_true;
+    std::vector<Block *> to_false;
+    for (auto *pred : preds) {
+        if (auto direction = GetDirection(pred, block)) {
+            (*direction ? to_true : to_false).push_back(pred);
+        }
+    }
+
+    // Every edge goes the same way, the branch itself is the copy
+    if (to_true.size() == preds.size() || to_false.size() == preds.size()) {
+#ifdef PRINT_DEBUG
+        std::cerr << "  Branch of " << block->GetName() << " always to "
+                  << (to_true.empty() ? false_blk : true_blk)->GetName()
+                  << "\n";
+#endif
+        ReplaceWithJmp(block, to_true.empty() ? false_blk : true_blk);
+        edges += preds.size();
+        return true;
+    }
+
+    bool threaded = false;
+    for (auto &[threads, target] :
+         {std::pair{&to_true, true_blk}, std::pair{&to_false, false_blk}}) {
+        if (threads->empty() || growth + size > max_growth) {
+            continue;
+        }
+
+#ifdef PRINT_DEBUG
+        std::cerr << "  Threading " << threads->size() << " edges through "
+                  << block->GetName() << " to " << target->GetName() << "\n";
+#endif
+        auto clones = CloneBlocks(func, {block},
+                                  "__sc_jt" + std::to_string(copies) + "_",
+                                  block->GetIndex() + 1);
+        auto *clone = clones[block];
+        ReplaceWithJmp(clone, target);
+        for (auto *pred : *threads) {
+            RedirectEdge(pred, block, clone);
+        }
+
+        growth += size;
+        edges += threads->size();
+        ++copies;
+        threaded = true;
+    }
+    return threaded;
+}
+
+std::optional<bool> JumpThreadTransformer::GetDirection(Block *pred,
+                                                        Block *block) const {
+    State state;
+    if (pred->GetPredecessorSize() == 1) {
+        Learn(state, pred->GetPredecessor(0), pred);
+    }
+    Simulate(state, pred);
+    Learn(state, pred, block);
+    Simulate(state, block);
+
+    auto it = state.find(LAST_INSTR(block)->GetOperand(0));
+    if (it == state.end()) {
+        return std::nullopt;
+    }
+    return static_cast<BoolOperand *>(it->second)->GetValue();
+}
+
+void JumpThreadTransformer::Learn(State &state, Block *from, Block *to) {
+    auto *last = LAST_INSTR(from);
+    if (last->GetOpcode() != Opcode::BR) {
+        return;
+    }
+
+    auto *br = static_cast<BranchInstruction *>(last);
+    auto *true_blk = br->GetTrueDest()->GetBlock();
+    if (true_blk != br->GetFalseDest()->GetBlock()) {
+        state[br->GetOperand(0)] = BoolOperand::GetOperand(true_blk == to);
+    }
+}
+
+void JumpThreadTransformer::Simulate(State &state, Block *block) {
+    for (auto *instr : block->GetInstructions()) {
+        auto *dest = instr->GetDest();
+        if (!dest) {
+            continue;
+        }
+
+        OperandBase *value = nullptr;
+        switch (instr->GetOpcode()) {
+        case Opcode::CONST:
+            value = instr->GetOperand(0);
+            break;
+        case Opcode::ID:
+        case Opcode::ADD:
+        case Opcode::MUL:
+        case Opcode::SUB:
+        case Opcode::DIV:
+        case Opcode::EQ:
+        case Opcode::LT:
+        case Opcode::GT:
+        case Opcode::LE:
+        case Opcode::GE:
+        case Opcode::AND:
+        case Opcode::OR:
+        case Opcode::NOT: {
+            std::vector<OperandBase *> ops;
+            for (auto *op : instr->GetOperands()) {
+                auto it = state.find(op);
+                if (it == state.end()) {
+                    break;
+                }
+                ops.push_back(it->second);
+            }
+            if (ops.size() != instr->GetOperandSize()) {
+                break;
+            }
+            value = instr->GetOpcode() == Opcode::ID
+                        ? ops[0]
+                        : IPSCCPTransformer::Fold(instr->GetOpcode(), ops);
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (value) {
+            state[dest] = value;
+        } else {
+            state.erase(dest);
+        }
+    }
+}
+// JumpThreadTransformer end
+} // namespace sc
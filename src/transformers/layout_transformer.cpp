@@ -0,0 +1,125 @@
+#include "transformers/layout_transformer.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// LayoutTransformer begin
+void LayoutTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    loops = func->GetAnalysis<LoopAnalyzer>();
+    auto edges = GetEdges();
+    std::ranges::stable_sort(edges, std::greater{}, &Edge::weight);
+
+    // Every block starts a chain of its own, the index of a chain is the
+    // one of its first block
+    std::vector<std::vector<Block *>> chains;
+    std::unordered_map<Block *, size_t> chain_of;
+    for (auto *block : func->GetBlocks()) {
+        chain_of[block] = chains.size();
+        chains.push_back({block});
+    }
+
+    auto *entry = func->GetBlock(0);
+    for (auto &edge : edges) {
+        auto from = chain_of[edge.from];
+        auto to = chain_of[edge.to];
+        if (from == to || chains[from].back() != edge.from ||
+            chains[to].front() != edge.to || edge.to == entry) {
+            continue;
+        }
+#ifdef PRINT_DEBUG
+        std::cerr << "  " << edge.to->GetName() << " falls through from "
+                  << edge.from->GetName() << " (" << edge.weight << ")\n";
+#endif
+        for (auto *block : chains[to]) {
+            chains[from].push_back(block);
+            chain_of[block] = from;
+        }
+        chains[to].clear();
+    }
+
+    // The entry chain first, the others by their hottest block
+    std::vector<std::pair<double, size_t>> rest;
+    for (size_t i = 1; i < chains.size(); ++i) {
+        if (chains[i].empty()) {
+            continue;
+        }
+        double heat = 0;
+        for (auto *block : chains[i]) {
+            heat = std::max(heat, GetFrequency(block));
+        }
+        rest.emplace_back(heat, i);
+    }
+    std::ranges::stable_sort(rest, std::greater{},
+                             &std::pair<double, size_t>::first);
+
+    std::vector<Block *> order = chains[0];
+    for (auto &[heat, i] : rest) {
+        order.insert(order.end(), chains[i].begin(), chains[i].end());
+    }
+    func->ReorderBlocks(order);
+
+    size_t fallthroughs = 0;
+    for (size_t i = 0; i + 1 < func->GetBlockSize(); ++i) {
+        auto *last = LAST_INSTR(func->GetBlock(i));
+        if (last->GetOpcode() == Opcode::JMP &&
+            static_cast<JmpInstruction *>(last)->GetJmpDest()->GetBlock() ==
+                func->GetBlock(i + 1)) {
+            ++fallthroughs;
+        }
+    }
+    Statistics::Get().Add("layout.fallthroughs", fallthroughs);
+}
+
+double LayoutTransformer::GetFrequency(Block *block) const {
+    return std::pow(loop_scale,
+                    static_cast<double>(loops->GetLoopDepth(block)));
+}
+
+std::vector<LayoutTransformer::Edge> LayoutTransformer::GetEdges() const {
+    std::vector<Edge> edges;
+    for (auto *block : func->GetBlocks()) {
+        auto frequency = GetFrequency(block);
+        std::vector<Block *> succs;
+        for (auto *succ : block->GetSuccessors()) {
+            if (std::ranges::find(succs, succ) == succs.end()) {
+                succs.push_back(succ);
+            }
+        }
+        for (auto *succ : succs) {
+            auto probability =
+                succs.size() == 1 ? 1.0 : GetProbability(block, succ);
+            edges.push_back({block, succ, frequency * probability});
+        }
+    }
+    return edges;
+}
+
+double LayoutTransformer::GetProbability(Block *block, Block *succ) const {
+    auto *loop = loops->GetLoopFor(block);
+    if (!loop) {
+        return 0.5;
+    }
+
+    auto *other = block->GetSuccessor(0) == succ ? block->GetSuccessor(1)
+                                                 : block->GetSuccessor(0);
+    // Leaving the loop
+    if (loop->Contains(succ) != loop->Contains(other)) {
+        return loop->Contains(succ) ? likely : 1 - likely;
+    }
+    // Going around it again
+    if ((succ == loop->GetHeader()) != (other == loop->GetHeader())) {
+        return succ == loop->GetHeader() ? likely : 1 - likely;
+    }
+    return 0.5;
+}
+// LayoutTransformer end
+} // namespace sc
@@ -0,0 +1,166 @@
+#include "transformers/licm_transformer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+// LICMTransformer begin
+void LICMTransformer::Transform() {
+    // Loops first since inserting preheaders invalidates the dominators
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    dom = func->GetAnalysis<DominatorAnalyzer>();
+    aa.Analyze();
+
+    for (auto *loop : loops->GetLoopsInnermostFirst()) {
+        Hoist(loop);
+    }
+
+    Statistics::Get().Add("licm.hoisted", hoisted);
+    Statistics::Get().Add("licm.hoisted_loads", hoisted_loads);
+}
+
+void LICMTransformer::Hoist(Loop *loop) {
+    auto *preheader = loop->GetPreheader();
+    if (!preheader) {
+        // The header is the entry block
+        return;
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Loop: " << loop->GetHeader()->GetName() << "\n";
+#endif
+
+    std::vector<Block *> exiting;
+    for (auto *block : loop->GetBlocks()) {
+        if (std::ranges::any_of(block->GetSuccessors(), [loop](Block *succ) {
+                return !loop->Contains(succ);
+            })) {
+            exiting.push_back(block);
+        }
+    }
+    auto writes = GetWrites(loop);
+
+    // Hoisting an instruction can make its users invariant
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto *block : loop->GetBlocks()) {
+            for (size_t i = 0; i < block->GetInstructionSize();) {
+                auto *instr = block->GetInstruction(i);
+                if (!IsInvariant(loop, instr) ||
+                    !IsSafeToHoist(loop, instr, exiting, writes)) {
+                    ++i;
+                    continue;
+                }
+
+#ifdef PRINT_DEBUG
+                instr->Dump(std::cerr << "  Hoisting: ");
+#endif
+                if (instr->GetOpcode() == Opcode::LOAD) {
+                    ++hoisted_loads;
+                }
+                ++hoisted;
+
+                // Right before the terminator of the preheader
+                preheader->InsertInstruction(
+                    block->ReleaseInstruction(i),
+                    preheader->GetInstructionSize() - 1);
+                changed = true;
+            }
+        }
+    }
+}
+
+bool LICMTransformer::IsInvariant(Loop *loop, InstructionBase *instr) const {
+    switch (instr->GetOpcode()) {
+    case Opcode::ADD:
+    case Opcode::MUL:
+    case Opcode::SUB:
+    case Opcode::DIV:
+    case Opcode::EQ:
+    case Opcode::LT:
+    case Opcode::GT:
+    case Opcode::LE:
+    case Opcode::GE:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::NOT:
+    case Opcode::LOAD:
+    case Opcode::PTRADD:
+    case Opcode::FADD:
+    case Opcode::FMUL:
+    case Opcode::FSUB:
+    case Opcode::FDIV:
+    case Opcode::FEQ:
+    case Opcode::FLT:
+    case Opcode::FLE:
+    case Opcode::FGT:
+    case Opcode::FGE:
+    case Opcode::ID:
+    case Opcode::CONST:
+        break;
+    default:
+        return false;
+    }
+
+    // In SSA form an operand defined outside the loop has the same value
+    // on every iteration.
+    return std::ranges::all_of(instr->GetOperands(), [loop](OperandBase *op) {
+        auto *def = op->GetDef();
+        return !def || !loop->Contains(def->GetBlock());
+    });
+}
+
+bool LICMTransformer::IsSafeToHoist(
+    Loop *loop, InstructionBase *instr, const std::vector<Block *> &exiting,
+    const std::vector<InstructionBase *> &writes) const {
+    auto opcode = instr->GetOpcode();
+    if (opcode == Opcode::DIV) {
+        // Division by a non-zero constant can't trap
+        auto *def = instr->GetOperand(1)->GetDef();
+        if (def && def->GetOpcode() == Opcode::CONST &&
+            static_cast<IntOperand *>(def->GetOperand(0))->GetValue() != 0) {
+            return true;
+        }
+    } else if (opcode == Opcode::LOAD) {
+        auto *ptr = instr->GetOperand(0);
+        if (std::ranges::any_of(writes, [this, ptr](InstructionBase *write) {
+                return aa.MayModify(write, ptr);
+            })) {
+            return false;
+        }
+    } else {
+        return true;
+    }
+
+    // May trap, only hoisted if it's executed whenever the loop is
+    // entered.
+    auto *block = instr->GetBlock();
+    assert(loop->Contains(block));
+    return !exiting.empty() &&
+           std::ranges::all_of(exiting, [this, block](Block *exit) {
+               return dom->Dominates(block, exit);
+           });
+}
+
+std::vector<InstructionBase *> LICMTransformer::GetWrites(Loop *loop) const {
+    std::vector<InstructionBase *> writes;
+    for (auto *block : loop->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            auto opcode = instr->GetOpcode();
+            if (opcode == Opcode::STORE || opcode == Opcode::CALL ||
+                opcode == Opcode::FREE) {
+                writes.push_back(instr);
+            }
+        }
+    }
+    return writes;
+}
+// LICMTransformer end
+} // namespace sc
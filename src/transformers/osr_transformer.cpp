@@ -0,0 +1,561 @@
+#include "transformers/osr_transformer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <ranges>
+#include <unordered_set>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+static bool IsTest(InstructionBase *instr) {
+    switch (instr->GetOpcode()) {
+    case Opcode::EQ:
+    case Opcode::LT:
+    case Opcode::GT:
+    case Opcode::LE:
+    case Opcode::GE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsIntConstant(OperandBase *op) {
+    auto *def = op->GetDef();
+    return def && def->GetOpcode() == Opcode::CONST &&
+           op->GetType() == DataType::INT;
+}
+
+static ValType::INT GetIntConstant(OperandBase *op) {
+    return static_cast<IntOperand *>(op->GetDef()->GetOperand(0))->GetValue();
+}
+
+// OSRTransformer begin
+void OSRTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    dom = func->GetAnalysis<DominatorAnalyzer>();
+    InductionAnalyzer iva(func);
+    iva.Analyze();
+
+    // Values the inner loops start from are derived induction variables
+    // of the enclosing loops.
+    for (auto *l : loops->GetLoopsInnermostFirst()) {
+        loop = l;
+        if (loop->GetPreheader() && ReduceLoop(iva)) {
+            iva.Analyze();
+        }
+    }
+
+    Statistics::Get().Add("osr.reduced", reductions);
+    Statistics::Get().Add("osr.lftr", replacements);
+}
+
+bool OSRTransformer::ReduceLoop(InductionAnalyzer &iva) {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Loop: " << loop->GetHeader()->GetName() << "\n";
+#endif
+    members.clear();
+    reduced.clear();
+    applied.clear();
+
+    auto &ivs = iva.GetInductionVariables(loop);
+    for (auto &iv : ivs) {
+        for (auto i : std::views::iota(0ul, iv.members.size())) {
+            members[iv.members[i]->GetDest()] = {&iv, i};
+        }
+    }
+
+    // Stepping a sum costs as much as computing it, additions are only
+    // reduced on the way to a multiplication or an address.
+    auto &derived = iva.GetDerivedInductionVariables(loop);
+    std::unordered_set<InstructionBase *> needed;
+    for (auto &div : derived | std::views::reverse) {
+        auto opcode = div.instr->GetOpcode();
+        if (opcode == Opcode::MUL || opcode == Opcode::PTRADD ||
+            needed.contains(div.instr)) {
+            needed.insert(div.instr);
+            needed.insert(div.iv->GetDef());
+        }
+    }
+
+    // The get and set of a new induction variable execute on every trip
+    // like the instructions it replaces, so only reduce the derived values
+    // of a basic induction variable when fewer instructions are added to
+    // the loop than removed from it. A reduction whose value is only used
+    // by other reduced instructions dies with them and costs nothing.
+    MarkLive();
+    using Group = std::tuple<const InductionVariable *, size_t, Opcode,
+                             const OperandBase *>;
+    std::map<Group, size_t> groups;
+    std::vector<std::pair<const InductionVariable *, bool>> kept;
+    std::unordered_map<OperandBase *, size_t> group_of;
+    std::unordered_map<const InductionVariable *, size_t> removed;
+    for (auto &div : derived) {
+        if (!needed.contains(div.instr)) {
+            continue;
+        }
+
+        auto it = members.find(div.iv);
+        auto base = it == members.end() ? group_of.at(div.iv) : SIZE_MAX;
+        auto *root = it == members.end() ? kept[base].first : it->second.first;
+        Group key{it == members.end() ? nullptr : root, base,
+                  div.instr->GetOpcode(), div.rc};
+        auto [git, inserted] = groups.try_emplace(key, kept.size());
+        if (inserted) {
+            kept.push_back({root, false});
+        }
+
+        group_of[div.instr->GetDest()] = git->second;
+        removed[root]++;
+        for (auto *use : div.instr->GetDest()->GetUses()) {
+            if (live.contains(use) && !needed.contains(use)) {
+                kept[git->second].second = true;
+            }
+        }
+    }
+
+    std::unordered_map<const InductionVariable *, size_t> added;
+    for (auto [root, used] : kept) {
+        if (!used) {
+            continue;
+        }
+        for (auto *instr : root->members) {
+            added[root]++;
+            if (instr->GetOpcode() != Opcode::GET) {
+                continue;
+            }
+            for (auto *seti : static_cast<GetInstruction *>(instr)->GetSetPairs()) {
+                added[root] += loop->Contains(seti->GetBlock());
+            }
+        }
+    }
+
+    std::vector<InstructionBase *> dead;
+    for (auto &div : derived) {
+        auto it = members.find(div.iv);
+        if (!needed.contains(div.instr) || it == members.end()) {
+            continue;
+        }
+
+        auto *root = kept[group_of.at(div.instr->GetDest())].first;
+        if (removed[root] <= added[root]) {
+            continue;
+        }
+
+        auto [iv, idx] = it->second;
+        if (!CanReduce(iv, div.rc)) {
+            continue;
+        }
+
+        auto *nv = Reduce(iv, div.instr->GetOpcode(), div.rc);
+        auto *value = nv->members[idx]->GetDest();
+
+#ifdef PRINT_DEBUG
+        div.instr->Dump(std::cerr << "  Reducing: ");
+        std::cerr << "    with: " << value->GetName() << "\n";
+#endif
+        members[div.instr->GetDest()] = {nv, idx};
+        ReplaceUses(div.instr->GetDest(), value);
+        dead.push_back(div.instr);
+    }
+
+    members.clear();
+    for (auto *instr : dead) {
+        instr->GetBlock()->RemoveInstruction(instr->GetIndex(), true);
+    }
+
+    MarkLive();
+    for (auto &iv : ivs) {
+        ReplaceTests(&iv);
+    }
+    return !dead.empty();
+}
+
+const InductionVariable *OSRTransformer::Reduce(const InductionVariable *iv,
+                                                Opcode op, OperandBase *rc) {
+    for (auto &r : reduced) {
+        if (r.iv == iv && r.op == op && r.rc == rc) {
+            return r.result;
+        }
+    }
+
+    // The new values are created first since the members refer to each
+    // other through the sets.
+    std::unordered_map<OperandBase *, OperandBase *> values;
+    std::vector<std::shared_ptr<OperandBase>> dests;
+    for (auto *instr : iv->members) {
+        dests.push_back(NewValue(op == Opcode::PTRADD ? rc : instr->GetDest()));
+        values[instr->GetDest()] = dests.back().get();
+    }
+
+    auto &nv = created.emplace_back(InductionVariable{loop, {}});
+    reduced.push_back({iv, op, rc, &nv});
+
+    for (auto i : std::views::iota(0ul, iv->members.size())) {
+        auto *instr = iv->members[i];
+        std::unique_ptr<InstructionBase> new_instr;
+
+        switch (instr->GetOpcode()) {
+        case Opcode::GET: {
+            auto get_instr = std::make_unique<GetInstruction>();
+            get_instr->SetShadow(dests[i].get());
+
+            // The values entering the cycle are scaled or offset, the
+            // ones carried around it are already the new values. Sets
+            // from outside the loop may come before the preheader, their
+            // values are scaled next to them and the region constants
+            // aren't all defined in the preheader yet.
+            auto *geti = static_cast<GetInstruction *>(instr);
+            for (auto *seti : geti->GetSetPairs()) {
+                auto *block = seti->GetBlock();
+                auto in_preheader = block == loop->GetPreheader();
+                if (!loop->Contains(block) && !in_preheader) {
+                    position = seti;
+                }
+
+                auto *op0 = seti->GetOperand(0);
+                auto *value = values.contains(op0) ? values[op0]
+                                                   : Apply(op, op0, rc);
+                position = nullptr;
+
+                auto set_instr = std::make_unique<SetInstruction>();
+                set_instr->SetShadow(dests[i].get());
+                SetOperandAndUse(set_instr.get(), value);
+                set_instr->SetGetPair(get_instr.get());
+                get_instr->SetSetPair(set_instr.get());
+                if (in_preheader) {
+                    Insert(std::move(set_instr));
+                } else {
+                    block->InsertInstruction(std::move(set_instr),
+                                             seti->GetIndex());
+                }
+            }
+            new_instr = std::move(get_instr);
+            break;
+        }
+        case Opcode::ID:
+            new_instr = std::make_unique<IdInstruction>();
+            SetOperandAndUse(new_instr.get(), values[instr->GetOperand(0)]);
+            break;
+        case Opcode::ADD:
+        case Opcode::SUB: {
+            // Only a multiplication scales the increments. The address
+            // of an induction variable steps like the variable, by a
+            // negated increment for a subtraction.
+            auto k = values.contains(instr->GetOperand(0)) ? 0ul : 1ul;
+            auto *step = instr->GetOperand(1 - k);
+            if (op == Opcode::MUL) {
+                step = Apply(Opcode::MUL, step, rc);
+            } else if (op == Opcode::PTRADD &&
+                       instr->GetOpcode() == Opcode::SUB) {
+                step = Apply(Opcode::MUL, step, Constant(-1, step));
+            }
+
+            if (op == Opcode::PTRADD) {
+                new_instr = std::make_unique<PtraddInstruction>();
+                SetOperandAndUse(new_instr.get(),
+                                 values[instr->GetOperand(k)]);
+                SetOperandAndUse(new_instr.get(), step);
+            } else {
+                new_instr = MakeInstruction(instr->GetOpcode());
+                for (auto j : std::views::iota(0ul, 2ul)) {
+                    SetOperandAndUse(new_instr.get(),
+                                     j == k ? values[instr->GetOperand(k)]
+                                            : step);
+                }
+            }
+            break;
+        }
+        default:
+            // ptradd only steps the induction variables of addresses,
+            // which aren't offsets themselves
+            assert(false && "Reduce: Unexpected member");
+        }
+
+        SetDestAndDef(new_instr.get(), dests[i]);
+        nv.members.push_back(new_instr.get());
+        instr->GetBlock()->InsertInstruction(std::move(new_instr),
+                                             instr->GetIndex() + 1);
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << "  New induction variable:";
+    for (auto *instr : nv.members) {
+        std::cerr << " " << instr->GetDest()->GetName();
+    }
+    std::cerr << "\n";
+#endif
+
+    ++reductions;
+    return &nv;
+}
+
+bool OSRTransformer::CanReduce(const InductionVariable *iv,
+                               OperandBase *rc) const {
+    // Constants are materialized again where they are needed
+    auto *def = rc->GetDef();
+    if (!def || IsIntConstant(rc)) {
+        return true;
+    }
+
+    for (auto *instr : iv->members) {
+        if (instr->GetOpcode() != Opcode::GET) {
+            continue;
+        }
+        for (auto *seti : static_cast<GetInstruction *>(instr)->GetSetPairs()) {
+            auto *block = seti->GetBlock();
+            if (loop->Contains(block) || block == loop->GetPreheader()) {
+                continue;
+            }
+            if (def->GetBlock() == block ? def->GetIndex() > seti->GetIndex()
+                                         : !dom->Dominates(def->GetBlock(),
+                                                           block)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+OperandBase *OSRTransformer::Apply(Opcode op, OperandBase *value,
+                                   OperandBase *rc) {
+    auto key = Key{value, op, rc, position};
+    if (applied.contains(key)) {
+        return applied[key];
+    }
+
+    // A constant of the loop may not reach the sets before the preheader
+    if (position && IsIntConstant(rc)) {
+        rc = Constant(GetIntConstant(rc), rc);
+    }
+
+    auto is = [](OperandBase *op, ValType::INT v) {
+        return IsIntConstant(op) && GetIntConstant(op) == v;
+    };
+
+    OperandBase *result;
+    if ((op == Opcode::MUL && (is(value, 0) || is(rc, 1))) ||
+        ((op == Opcode::ADD || op == Opcode::SUB) && is(rc, 0))) {
+        result = value;
+    } else if ((op == Opcode::MUL && (is(rc, 0) || is(value, 1))) ||
+               ((op == Opcode::ADD || op == Opcode::PTRADD) && is(value, 0))) {
+        result = rc;
+    } else if (op != Opcode::PTRADD && IsIntConstant(value) &&
+               IsIntConstant(rc)) {
+        auto a = GetIntConstant(value);
+        auto b = GetIntConstant(rc);
+        auto c = op == Opcode::MUL ? a * b : op == Opcode::ADD ? a + b : a - b;
+        result = c == a ? value : c == b ? rc : Constant(c, value);
+    } else {
+        // The address operand comes first
+        auto instr = MakeInstruction(op);
+        SetDestAndDef(instr.get(),
+                      NewValue(op == Opcode::PTRADD ? rc : value));
+        SetOperandAndUse(instr.get(), op == Opcode::PTRADD ? rc : value);
+        SetOperandAndUse(instr.get(), op == Opcode::PTRADD ? value : rc);
+        result = Insert(std::move(instr))->GetDest();
+    }
+
+    applied[key] = result;
+    return result;
+}
+
+OperandBase *OSRTransformer::Constant(ValType::INT value, OperandBase *type) {
+    auto *imm = IntOperand::GetOperand(value);
+    auto key = Key{imm, Opcode::CONST, nullptr, position};
+    if (applied.contains(key)) {
+        return applied[key];
+    }
+
+    auto instr = std::make_unique<ConstInstruction>();
+    SetDestAndDef(instr.get(), NewValue(type));
+    SetOperandAndUse(instr.get(), imm);
+    return applied[key] = Insert(std::move(instr))->GetDest();
+}
+
+InstructionBase *
+OSRTransformer::Insert(std::unique_ptr<InstructionBase> instr) {
+    auto *ptr = instr.get();
+    if (position) {
+        position->GetBlock()->InsertInstruction(std::move(instr),
+                                                position->GetIndex());
+    } else {
+        auto *preheader = loop->GetPreheader();
+        preheader->InsertInstruction(std::move(instr),
+                                     preheader->GetInstructionSize() - 1);
+    }
+    return ptr;
+}
+
+std::shared_ptr<OperandBase> OSRTransformer::NewValue(OperandBase *type) {
+    auto value = type->Clone();
+    value->SetName(std::format("__sc_osr.{}", count++));
+    return value;
+}
+
+void OSRTransformer::MarkLive() {
+    // Instructions an effect depends on, as in the mark phase of DCE
+    // without control dependences. Dead uses left by earlier passes
+    // shouldn't keep an induction variable alive.
+    live.clear();
+    std::vector<InstructionBase *> worklist;
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            switch (instr->GetOpcode()) {
+            case Opcode::BR:
+            case Opcode::JMP:
+            case Opcode::RET:
+            case Opcode::PRINT:
+            case Opcode::CALL:
+            case Opcode::ALLOC:
+            case Opcode::FREE:
+            case Opcode::STORE:
+            case Opcode::GETARG:
+                live.insert(instr);
+                worklist.push_back(instr);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    while (!worklist.empty()) {
+        auto *instr = worklist.back();
+        worklist.pop_back();
+
+        std::vector<InstructionBase *> defs;
+        if (instr->GetOpcode() == Opcode::GET) {
+            auto *geti = static_cast<GetInstruction *>(instr);
+            defs.assign(geti->GetSetPairs().begin(), geti->GetSetPairs().end());
+        } else {
+            for (auto *op : instr->GetOperands()) {
+                if (op->GetDef()) {
+                    defs.push_back(op->GetDef());
+                }
+            }
+        }
+
+        for (auto *def : defs) {
+            if (live.insert(def).second) {
+                worklist.push_back(def);
+            }
+        }
+    }
+}
+
+void OSRTransformer::ReplaceTests(const InductionVariable *iv) {
+    // The test needs an order preserving function of the old variable
+    // that is computed anyway, otherwise one induction variable would
+    // just replace the other.
+    const Reduction *rep = nullptr;
+    for (auto &r : reduced) {
+        if (r.iv == iv &&
+            (r.op == Opcode::ADD || r.op == Opcode::SUB ||
+             (r.op == Opcode::MUL && IsIntConstant(r.rc) &&
+              GetIntConstant(r.rc) > 0)) &&
+            std::ranges::any_of(r.result->members,
+                                [this](auto *m) { return live.contains(m); })) {
+            rep = &r;
+            break;
+        }
+    }
+    if (!rep) {
+        return;
+    }
+
+    std::unordered_set<InstructionBase *> cycle(iv->members.begin(),
+                                                iv->members.end());
+    auto is_rc = [this](OperandBase *op) {
+        return InductionAnalyzer::IsRegionConstant(loop, op);
+    };
+    auto other = [](InstructionBase *instr, OperandBase *op) {
+        return instr->GetOperand(instr->GetOperand(0) == op ? 1 : 0);
+    };
+    auto is_test = [&](InstructionBase *instr, OperandBase *op) {
+        return IsTest(instr) && is_rc(other(instr, op));
+    };
+
+    // Tests of a member, directly or offset by a region constant as in
+    // the checks of unrolled loops
+    std::vector<std::pair<InstructionBase *, size_t>> tests;
+    std::vector<std::pair<InstructionBase *, size_t>> offsets;
+    for (auto i : std::views::iota(0ul, iv->members.size())) {
+        auto *value = iv->members[i]->GetDest();
+        for (auto *use : value->GetUses()) {
+            if (!live.contains(use) || cycle.contains(use) ||
+                (use->GetOpcode() == Opcode::SET &&
+                 cycle.contains(static_cast<SetInstruction *>(use)
+                                    ->GetGetPair()))) {
+                continue;
+            }
+
+            auto *offset = use->GetDest();
+            if (is_test(use, value)) {
+                tests.push_back({use, i});
+            } else if ((use->GetOpcode() == Opcode::ADD ||
+                        (use->GetOpcode() == Opcode::SUB &&
+                         use->GetOperand(0) == value)) &&
+                       is_rc(other(use, value)) && offset->GetUsesSize() &&
+                       std::ranges::all_of(offset->GetUses(),
+                                           [&](InstructionBase *test) {
+                                               return is_test(test, offset);
+                                           })) {
+                offsets.push_back({use, i});
+            } else {
+                // Still needed, replacing the tests would only add work
+                return;
+            }
+        }
+    }
+
+    // Swaps the old member for the new one and returns the index of the
+    // other operand
+    auto replace = [&](InstructionBase *instr, size_t i) {
+        auto k = instr->GetOperand(0) == iv->members[i]->GetDest() ? 0ul : 1ul;
+        SetOperandAndUse(instr, rep->result->members[i]->GetDest(), k);
+        return 1 - k;
+    };
+    auto replace_bound = [&](InstructionBase *test, size_t k) {
+        SetOperandAndUse(test, Apply(rep->op, test->GetOperand(k), rep->rc),
+                         k);
+        ++replacements;
+    };
+
+    for (auto [test, i] : tests) {
+#ifdef PRINT_DEBUG
+        test->Dump(std::cerr << "  Replacing Test: ");
+#endif
+        replace_bound(test, replace(test, i));
+    }
+
+    // old + c becomes new + c, or new + c * rc when scaled, and its tests
+    // compare against the new bound
+    for (auto [offset, i] : offsets) {
+        auto k = replace(offset, i);
+        if (rep->op == Opcode::MUL) {
+            SetOperandAndUse(
+                offset, Apply(Opcode::MUL, offset->GetOperand(k), rep->rc), k);
+        }
+
+        auto *value = offset->GetDest();
+        std::vector<InstructionBase *> uses(value->GetUses().begin(),
+                                            value->GetUses().end());
+        for (auto *test : uses) {
+            replace_bound(test, test->GetOperand(0) == value ? 1ul : 0ul);
+        }
+    }
+}
+// OSRTransformer end
+} // namespace sc
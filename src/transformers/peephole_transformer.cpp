@@ -0,0 +1,115 @@
+#include "transformers/peephole_transformer.hpp"
+#include "statistics.hpp"
+#include "transformers/peephole.hpp"
+#include <vector>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+
+namespace peephole {
+void ReplaceWithValue(InstructionBase *root, OperandBase *value) {
+    ReplaceUses(root->GetDest(), value);
+    root->GetBlock()->RemoveInstruction(root->GetIndex(), true);
+}
+
+void ReplaceWithConst(InstructionBase *root, OperandBase *imm) {
+    ReplaceWithInstruction(root, Opcode::CONST, {imm});
+}
+
+void ReplaceWithInstruction(InstructionBase *root, Opcode opcode,
+                            const std::vector<OperandBase *> &ops) {
+    auto instr = MakeInstruction(opcode);
+    for (auto *op : ops) {
+        SetOperandAndUse(instr.get(), op);
+    }
+    SetDestAndDef(instr.get(), root->ReleaseDest());
+    root->GetBlock()->AddInstruction(std::move(instr), root->GetIndex(), true);
+}
+} // namespace peephole
+
+using namespace peephole;
+
+// clang-format off
+using PeepholeRules = RuleTable<
+    // Arithmetic
+    Rule<Inst<Opcode::ADD, Var<0>, Int<0>>, Value<0>>,
+    Rule<Inst<Opcode::ADD, Inst<Opcode::SUB, Var<0>, Var<1>>, Var<1>>, Value<0>>,
+    Rule<Inst<Opcode::SUB, Var<0>, Var<0>>, IntConst<0>>,
+    Rule<Inst<Opcode::SUB, Var<0>, Int<0>>, Value<0>>,
+    Rule<Inst<Opcode::SUB, Inst<Opcode::ADD, Var<0>, Var<1>>, Var<1>>, Value<0>>,
+    Rule<Inst<Opcode::SUB, Var<0>, Inst<Opcode::SUB, Var<0>, Var<1>>>, Value<1>>,
+    Rule<Inst<Opcode::MUL, Var<0>, Int<0>>, IntConst<0>>,
+    Rule<Inst<Opcode::MUL, Var<0>, Int<1>>, Value<0>>,
+    Rule<Inst<Opcode::MUL, Var<0>, Int<2>>, New<Opcode::ADD, 0, 0>>,
+    Rule<Inst<Opcode::DIV, Var<0>, Int<1>>, Value<0>>,
+    // Comparison
+    Rule<Inst<Opcode::EQ, Var<0>, Var<0>>, BoolConst<true>>,
+    Rule<Inst<Opcode::LE, Var<0>, Var<0>>, BoolConst<true>>,
+    Rule<Inst<Opcode::GE, Var<0>, Var<0>>, BoolConst<true>>,
+    Rule<Inst<Opcode::LT, Var<0>, Var<0>>, BoolConst<false>>,
+    Rule<Inst<Opcode::GT, Var<0>, Var<0>>, BoolConst<false>>,
+    // Logic
+    Rule<Inst<Opcode::NOT, Inst<Opcode::NOT, Var<0>>>, Value<0>>,
+    Rule<Inst<Opcode::NOT, Inst<Opcode::LT, Var<0>, Var<1>>>, New<Opcode::GE, 0, 1>>,
+    Rule<Inst<Opcode::NOT, Inst<Opcode::LE, Var<0>, Var<1>>>, New<Opcode::GT, 0, 1>>,
+    Rule<Inst<Opcode::NOT, Inst<Opcode::GT, Var<0>, Var<1>>>, New<Opcode::LE, 0, 1>>,
+    Rule<Inst<Opcode::NOT, Inst<Opcode::GE, Var<0>, Var<1>>>, New<Opcode::LT, 0, 1>>,
+    Rule<Inst<Opcode::NOT, Bool<true>>, BoolConst<false>>,
+    Rule<Inst<Opcode::NOT, Bool<false>>, BoolConst<true>>,
+    Rule<Inst<Opcode::AND, Var<0>, Var<0>>, Value<0>>,
+    Rule<Inst<Opcode::AND, Var<0>, Bool<true>>, Value<0>>,
+    Rule<Inst<Opcode::AND, Var<0>, Bool<false>>, BoolConst<false>>,
+    Rule<Inst<Opcode::AND, Var<0>, Inst<Opcode::NOT, Var<0>>>, BoolConst<false>>,
+    Rule<Inst<Opcode::OR, Var<0>, Var<0>>, Value<0>>,
+    Rule<Inst<Opcode::OR, Var<0>, Bool<false>>, Value<0>>,
+    Rule<Inst<Opcode::OR, Var<0>, Bool<true>>, BoolConst<true>>,
+    Rule<Inst<Opcode::OR, Var<0>, Inst<Opcode::NOT, Var<0>>>, BoolConst<true>>
+>;
+// clang-format on
+
+// PeepholeTransformer begin
+void PeepholeTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto *block : func->GetBlocks()) {
+            changed |= Sweep(block);
+        }
+    }
+
+    Statistics::Get().Add("peephole.rewrites", rewritten);
+}
+
+bool PeepholeTransformer::Sweep(Block *block) {
+    // A rewrite replaces or removes only the instruction it matched
+    std::vector<InstructionBase *> instrs;
+    for (auto *instr : block->GetInstructions()) {
+        instrs.push_back(instr);
+    }
+
+    bool changed = false;
+    for (auto *instr : instrs) {
+        auto rules = PeepholeRules::Lookup(instr->GetOpcode());
+#ifdef PRINT_DEBUG
+        if (!rules.empty()) {
+            instr->Dump(std::cerr << "  Matching: ");
+        }
+#endif
+        for (auto apply : rules) {
+            if (apply(instr)) {
+                ++rewritten;
+                changed = true;
+                break;
+            }
+        }
+    }
+    return changed;
+}
+// PeepholeTransformer end
+} // namespace sc
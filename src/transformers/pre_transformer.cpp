@@ -0,0 +1,346 @@
+#include "transformers/pre_transformer.hpp"
+#include "analyzers/cfg.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <format>
+#include <ranges>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+// PRETransformer begin
+void PRETransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    dom = func->GetAnalysis<DominatorAnalyzer>();
+    auto cfg = ForwardCFG(func);
+    auto rpo = GetReversePostOrder(&cfg);
+    reachable = {rpo.begin(), rpo.end()};
+
+    // Values inserted for a join are available to the joins after it
+    CollectExpressions();
+    for (auto *block : rpo) {
+        Eliminate(block);
+    }
+
+    Statistics::Get().Add("pre.eliminated", eliminated);
+    Statistics::Get().Add("pre.inserted", inserted);
+}
+
+void PRETransformer::Eliminate(Block *block) {
+    std::vector<GetInstruction *> gets;
+    for (auto *instr : block->GetInstructions()) {
+        if (instr->GetOpcode() == Opcode::GET) {
+            gets.push_back(static_cast<GetInstruction *>(instr));
+        }
+    }
+    if (gets.empty()) {
+        return;
+    }
+
+    // The incoming paths are the blocks holding the sets of the gets,
+    // which are the same for every get of the block unless a pass left
+    // some of them elsewhere.
+    auto set_blocks = [](GetInstruction *geti) {
+        std::vector<Block *> blocks;
+        for (auto *seti : geti->GetSetPairs()) {
+            blocks.push_back(seti->GetBlock());
+        }
+        std::ranges::sort(blocks, {}, &Block::GetIndex);
+        return blocks;
+    };
+
+    auto paths = set_blocks(gets[0]);
+    if (std::ranges::adjacent_find(paths) != paths.end() ||
+        !std::ranges::all_of(paths,
+                             [this](Block *b) { return reachable.contains(b); }) ||
+        !std::ranges::all_of(gets, [&](GetInstruction *geti) {
+            return set_blocks(geti) == paths;
+        })) {
+        return;
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Block: " << block->GetName() << "\n";
+#endif
+
+    std::vector<InstructionBase *> candidates;
+    for (auto *instr : block->GetInstructions()) {
+        if (IsCandidate(instr)) {
+            candidates.push_back(instr);
+        }
+    }
+
+    for (auto *instr : candidates) {
+        if (Eliminate(instr, gets, paths)) {
+            ++eliminated;
+            CollectExpressions();
+        }
+    }
+}
+
+bool PRETransformer::Eliminate(InstructionBase *instr,
+                               std::vector<GetInstruction *> &gets,
+                               const std::vector<Block *> &paths) {
+    auto *block = instr->GetBlock();
+    std::unordered_map<OperandBase *, GetInstruction *> get_of;
+    for (auto *geti : gets) {
+        get_of[geti->GetDest()] = geti;
+    }
+
+    // Operands computed in the block other than by its gets have no
+    // value on the incoming paths
+    if (std::ranges::any_of(instr->GetOperands(), [&](OperandBase *op) {
+            auto *def = op->GetDef();
+            return def && def->GetBlock() == block && !get_of.contains(op);
+        })) {
+        return false;
+    }
+
+    auto translate = [&get_of](OperandBase *op, Block *path) {
+        if (!get_of.contains(op)) {
+            return op;
+        }
+        auto sets = get_of[op]->GetSetPairs();
+        auto it = std::ranges::find(sets, path, &SetInstruction::GetBlock);
+        assert(it != sets.end());
+        return (*it)->GetOperand(0);
+    };
+
+    // The expression on every path and the instruction computing it at
+    // the end of the path, nullptr where it has to be inserted
+    std::vector<std::vector<OperandBase *>> operands(paths.size());
+    std::vector<InstructionBase *> values(paths.size());
+    for (auto k : std::views::iota(0ul, paths.size())) {
+        auto *path = paths[k];
+        auto end = path->GetInstructionSize() - 1;
+        for (auto *op : instr->GetOperands()) {
+            operands[k].push_back(translate(op, path));
+        }
+
+        values[k] = FindAvailable(GetKey(instr, operands[k]), path, end);
+        if (values[k]) {
+            continue;
+        }
+
+        // Inserted right before the terminator, only on the way to the
+        // block so that no path computes more than before
+        if (path->GetSuccessorSize() != 1 ||
+            !std::ranges::all_of(operands[k], [&](OperandBase *op) {
+                return IsAvailable(op, path, end);
+            })) {
+            return false;
+        }
+    }
+
+    // The gets only used by the expression die with it
+    std::vector<GetInstruction *> dead;
+    for (auto *geti : gets) {
+        auto uses = geti->GetDest()->GetUses();
+        if (!uses.empty() && std::ranges::all_of(uses, [instr](auto *use) {
+                return use == instr;
+            })) {
+            dead.push_back(geti);
+        }
+    }
+
+    // Paths where the expression is available as itself come back around
+    // a loop. When the other paths are a single one whose value reaches
+    // the expression, that value is used directly.
+    std::vector<size_t> sources;
+    for (auto k : std::views::iota(0ul, paths.size())) {
+        if (values[k] != instr) {
+            sources.push_back(k);
+        }
+    }
+    assert(!sources.empty());
+
+    bool need_get = true;
+    if (sources.size() == 1) {
+        auto k = sources[0];
+        need_get = values[k] ? !IsAvailable(values[k]->GetDest(), block,
+                                            instr->GetIndex())
+                             : paths[k] == block ||
+                                   !dom->Dominates(paths[k], block);
+    }
+
+    // Every get and set counts as an executed instruction
+    bool gain = false;
+    for (auto *value : values) {
+        auto delta = -1l + (need_get ? 2l : 0l) + (value ? 0l : 1l) -
+                     2l * static_cast<long>(dead.size());
+        if (delta > 0) {
+            return false;
+        }
+        gain |= delta < 0;
+    }
+    if (!gain) {
+        return false;
+    }
+
+#ifdef PRINT_DEBUG
+    instr->Dump(std::cerr << "  Eliminating: ");
+#endif
+
+    std::vector<OperandBase *> incoming(paths.size());
+    for (auto k : sources) {
+        auto *path = paths[k];
+        if (values[k]) {
+            incoming[k] = values[k]->GetDest();
+            continue;
+        }
+
+        auto new_instr = MakeInstruction(instr->GetOpcode());
+        SetDestAndDef(new_instr.get(), NewValue(instr->GetDest()));
+        for (auto *op : operands[k]) {
+            SetOperandAndUse(new_instr.get(), op);
+        }
+        incoming[k] = new_instr->GetDest();
+
+#ifdef PRINT_DEBUG
+        new_instr->Dump(std::cerr << "    Inserting in " << path->GetName()
+                                  << ": ");
+#endif
+        path->InsertInstruction(std::move(new_instr),
+                                path->GetInstructionSize() - 1);
+        ++inserted;
+    }
+
+    OperandBase *value = incoming[sources[0]];
+    if (need_get) {
+        auto dest = NewValue(instr->GetDest());
+        value = dest.get();
+
+        auto get_instr = std::make_unique<GetInstruction>();
+        get_instr->SetShadow(value);
+        SetDestAndDef(get_instr.get(), dest);
+        for (auto k : std::views::iota(0ul, paths.size())) {
+            auto set_instr = std::make_unique<SetInstruction>();
+            set_instr->SetShadow(value);
+            SetOperandAndUse(set_instr.get(),
+                             values[k] == instr ? value : incoming[k]);
+            set_instr->SetGetPair(get_instr.get());
+            get_instr->SetSetPair(set_instr.get());
+            paths[k]->InsertInstruction(std::move(set_instr),
+                                        paths[k]->GetInstructionSize() - 1);
+        }
+
+        gets.push_back(get_instr.get());
+        block->InsertInstruction(std::move(get_instr), 0ul);
+    }
+
+    ReplaceUses(instr->GetDest(), value);
+    block->RemoveInstruction(instr->GetIndex(), true);
+
+    for (auto *geti : dead) {
+        for (auto *seti : geti->GetSetPairs()) {
+            seti->GetBlock()->RemoveInstruction(seti->GetIndex(), true);
+        }
+        std::erase(gets, geti);
+        block->RemoveInstruction(geti->GetIndex(), true);
+    }
+    return true;
+}
+
+bool PRETransformer::IsCandidate(InstructionBase *instr) {
+    // Pure and can't trap, the expression may be computed on paths
+    // where it wasn't before
+    switch (instr->GetOpcode()) {
+    case Opcode::ADD:
+    case Opcode::MUL:
+    case Opcode::SUB:
+    case Opcode::EQ:
+    case Opcode::LT:
+    case Opcode::GT:
+    case Opcode::LE:
+    case Opcode::GE:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::NOT:
+    case Opcode::PTRADD:
+    case Opcode::FADD:
+    case Opcode::FMUL:
+    case Opcode::FSUB:
+    case Opcode::FDIV:
+    case Opcode::FEQ:
+    case Opcode::FLT:
+    case Opcode::FLE:
+    case Opcode::FGT:
+    case Opcode::FGE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+PRETransformer::Key
+PRETransformer::GetKey(InstructionBase *instr,
+                       const std::vector<OperandBase *> &ops) {
+    if (ops.size() == 1) {
+        return {instr->GetOpcode(), ops[0], nullptr};
+    }
+
+    auto *lop = ops[0];
+    auto *rop = ops[1];
+    if (static_cast<BinaryOperator *>(instr)->Commutative() &&
+        std::less<>{}(rop, lop)) {
+        std::swap(lop, rop);
+    }
+    return {instr->GetOpcode(), lop, rop};
+}
+
+bool PRETransformer::IsAvailable(OperandBase *op, Block *block,
+                                 size_t idx) const {
+    auto *def = op->GetDef();
+    if (!def) {
+        return true;
+    }
+
+    auto *def_block = def->GetBlock();
+    return def_block == block ? def->GetIndex() < idx
+                              : dom->Dominates(def_block, block);
+}
+
+InstructionBase *PRETransformer::FindAvailable(const Key &key, Block *block,
+                                               size_t idx) const {
+    auto it = exprs.find(key);
+    if (it == exprs.end()) {
+        return nullptr;
+    }
+
+    auto found = std::ranges::find_if(it->second, [&](InstructionBase *instr) {
+        return IsAvailable(instr->GetDest(), block, idx);
+    });
+    return found == it->second.end() ? nullptr : *found;
+}
+
+void PRETransformer::CollectExpressions() {
+    exprs.clear();
+    for (auto *block : func->GetBlocks()) {
+        if (!reachable.contains(block)) {
+            continue;
+        }
+        for (auto *instr : block->GetInstructions()) {
+            if (!IsCandidate(instr)) {
+                continue;
+            }
+            auto ops = instr->GetOperands();
+            exprs[GetKey(instr, {ops.begin(), ops.end()})].push_back(instr);
+        }
+    }
+}
+
+std::shared_ptr<OperandBase> PRETransformer::NewValue(OperandBase *type) {
+    auto value = type->Clone();
+    value->SetName(std::format("__sc_pre.{}", count++));
+    return value;
+}
+// PRETransformer end
+} // namespace sc
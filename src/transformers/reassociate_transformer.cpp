@@ -0,0 +1,265 @@
+#include "transformers/reassociate_transformer.hpp"
+#include "analyzers/cfg.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include "transformers/ipsccp_transformer.hpp"
+#include <algorithm>
+#include <format>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+
+// Whether the immediate imm is value for the operands of opcode
+static bool IsValue(Opcode opcode, OperandBase *imm, ValType::INT value) {
+    if (opcode == Opcode::ADD || opcode == Opcode::MUL) {
+        return static_cast<IntOperand *>(imm)->GetValue() == value;
+    }
+    return static_cast<BoolOperand *>(imm)->GetValue() == (value != 0);
+}
+
+// x op identity == x
+static bool IsIdentity(Opcode opcode, OperandBase *imm) {
+    return IsValue(opcode, imm,
+                   opcode == Opcode::MUL || opcode == Opcode::AND ? 1 : 0);
+}
+
+// x op absorbing == absorbing
+static bool IsAbsorbing(Opcode opcode, OperandBase *imm) {
+    switch (opcode) {
+    case Opcode::MUL:
+    case Opcode::AND:
+        return IsValue(opcode, imm, 0);
+    case Opcode::OR:
+        return IsValue(opcode, imm, 1);
+    default:
+        return false;
+    }
+}
+
+// ReassociateTransformer begin
+void ReassociateTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    Rank();
+
+    for (auto *block : func->GetBlocks()) {
+        std::vector<InstructionBase *> roots;
+        for (auto *instr : block->GetInstructions()) {
+            if (IsRoot(instr)) {
+                roots.push_back(instr);
+            }
+        }
+        for (auto *root : roots) {
+            Reassociate(root);
+        }
+    }
+
+    Statistics::Get().Add("reassociate.trees", rewritten);
+}
+
+void ReassociateTransformer::Rank() {
+    auto cfg = ForwardCFG(func);
+    size_t rank = 0;
+    for (auto *block : GetReversePostOrder(&cfg)) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetDest()) {
+                ranks[instr->GetDest()] = ++rank;
+            }
+        }
+    }
+}
+
+bool ReassociateTransformer::IsRoot(InstructionBase *instr) const {
+    auto opcode = instr->GetOpcode();
+    if (opcode != Opcode::ADD && opcode != Opcode::MUL &&
+        opcode != Opcode::AND && opcode != Opcode::OR) {
+        return false;
+    }
+
+    // Inner values are flattened into the tree of their only use
+    auto *dest = instr->GetDest();
+    return dest->GetUsesSize() != 1 ||
+           dest->GetUse(0)->GetOpcode() != opcode ||
+           dest->GetUse(0)->GetBlock() != instr->GetBlock();
+}
+
+void ReassociateTransformer::Flatten(
+    InstructionBase *instr, std::vector<OperandBase *> &leaves,
+    std::vector<InstructionBase *> &inner) const {
+    for (auto *op : instr->GetOperands()) {
+        auto *def = op->GetDef();
+        if (def && def->GetOpcode() == instr->GetOpcode() &&
+            def->GetBlock() == instr->GetBlock() && op->GetUsesSize() == 1) {
+            // Users before the values they use, the order they are removed
+            inner.push_back(def);
+            Flatten(def, leaves, inner);
+        } else {
+            leaves.push_back(op);
+        }
+    }
+}
+
+void ReassociateTransformer::Reassociate(InstructionBase *root) {
+    auto opcode = root->GetOpcode();
+    auto *block = root->GetBlock();
+
+    std::vector<OperandBase *> leaves;
+    std::vector<InstructionBase *> inner;
+    Flatten(root, leaves, inner);
+
+    // Constants are folded, the other operands sorted by rank
+    std::vector<OperandBase *> terms;
+    std::vector<OperandBase *> constants;
+    for (auto *leaf : leaves) {
+        auto *def = leaf->GetDef();
+        if (def && def->GetOpcode() == Opcode::CONST) {
+            constants.push_back(leaf);
+        } else {
+            terms.push_back(leaf);
+        }
+    }
+    std::ranges::stable_sort(terms, {}, [this](OperandBase *op) {
+        auto it = ranks.find(op);
+        return it == ranks.end() ? 0 : it->second;
+    });
+
+    OperandBase *imm = nullptr;
+    OperandBase *constant = nullptr;
+    for (auto *leaf : constants) {
+        auto *value = leaf->GetDef()->GetOperand(0);
+        imm = imm ? IPSCCPTransformer::Fold(opcode, {imm, value}) : value;
+    }
+    if (constants.size() == 1) {
+        constant = constants[0];
+    }
+
+    bool changed = !inner.empty() || constants.size() > 1;
+    if (imm && IsAbsorbing(opcode, imm)) {
+        terms.clear();
+        changed = true;
+    } else if (imm && IsIdentity(opcode, imm) && !terms.empty()) {
+        imm = constant = nullptr;
+        changed = true;
+    }
+
+    bool twice = false;
+    if (opcode == Opcode::MUL && imm && IsValue(opcode, imm, 2) &&
+        !terms.empty()) {
+        imm = constant = nullptr;
+        twice = changed = true;
+    }
+
+    std::vector<std::unique_ptr<InstructionBase>> instrs;
+    std::vector<OperandBase *> values;
+    for (size_t i = 0, j = 0; i < terms.size(); i = j) {
+        while (j < terms.size() && terms[j] == terms[i]) {
+            ++j;
+        }
+
+        auto repeats = j - i;
+        if (opcode == Opcode::ADD && repeats > 2) {
+            instrs.push_back(NewConstant(
+                IntOperand::GetOperand(static_cast<ValType::INT>(repeats)),
+                root));
+            auto *times = instrs.back()->GetDest();
+            instrs.push_back(
+                NewInstruction(Opcode::MUL, terms[i], times, nullptr, root));
+            values.push_back(instrs.back()->GetDest());
+            changed = true;
+        } else if ((opcode == Opcode::AND || opcode == Opcode::OR) &&
+                   repeats > 1) {
+            values.push_back(terms[i]);
+            changed = true;
+        } else {
+            values.insert(values.end(), repeats, terms[i]);
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+#ifdef PRINT_DEBUG
+    root->Dump(std::cerr << "  Reassociating: ");
+#endif
+
+    if (imm && !constant) {
+        instrs.push_back(NewConstant(imm, root));
+        constant = instrs.back()->GetDest();
+    }
+    if (constant) {
+        values.push_back(constant);
+    }
+
+    std::unique_ptr<InstructionBase> new_root;
+    if (values.empty()) {
+        // Only constants, or an absorbing one
+        new_root = MakeInstruction(Opcode::CONST);
+        SetOperandAndUse(new_root.get(), imm);
+        SetDestAndDef(new_root.get(), root->ReleaseDest());
+    } else if (values.size() == 1 && !twice) {
+        new_root = MakeInstruction(Opcode::ID);
+        SetOperandAndUse(new_root.get(), values[0]);
+        SetDestAndDef(new_root.get(), root->ReleaseDest());
+    } else {
+        auto *acc = values[0];
+        for (size_t i = 1; i + 1 < values.size(); ++i) {
+            instrs.push_back(
+                NewInstruction(opcode, acc, values[i], nullptr, root));
+            acc = instrs.back()->GetDest();
+        }
+        if (twice) {
+            if (values.size() > 1) {
+                instrs.push_back(
+                    NewInstruction(opcode, acc, values.back(), nullptr, root));
+                acc = instrs.back()->GetDest();
+            }
+            new_root = NewInstruction(Opcode::ADD, acc, acc,
+                                      root->ReleaseDest(), root);
+        } else {
+            new_root = NewInstruction(opcode, acc, values.back(),
+                                      root->ReleaseDest(), root);
+        }
+    }
+
+    auto idx = root->GetIndex();
+    auto size = instrs.size();
+    block->InsertInstructions(std::move(instrs), idx);
+    block->AddInstruction(std::move(new_root), idx + size, true);
+    for (auto *instr : inner) {
+        block->RemoveInstruction(instr->GetIndex(), true);
+    }
+    ++rewritten;
+}
+
+std::unique_ptr<InstructionBase> ReassociateTransformer::NewInstruction(
+    Opcode opcode, OperandBase *a, OperandBase *b,
+    std::shared_ptr<OperandBase> dest, InstructionBase *root) {
+    if (!dest) {
+        dest = root->GetDest()->Clone();
+        dest->SetName(std::format("__sc_ra.{}", count++));
+    }
+
+    auto instr = MakeInstruction(opcode);
+    SetOperandAndUse(instr.get(), a);
+    SetOperandAndUse(instr.get(), b);
+    SetDestAndDef(instr.get(), dest);
+    return instr;
+}
+
+std::unique_ptr<InstructionBase>
+ReassociateTransformer::NewConstant(OperandBase *imm, InstructionBase *root) {
+    auto dest = root->GetDest()->Clone();
+    dest->SetName(std::format("__sc_ra.{}", count++));
+
+    auto instr = MakeInstruction(Opcode::CONST);
+    SetOperandAndUse(instr.get(), imm);
+    SetDestAndDef(instr.get(), dest);
+    return instr;
+}
+// ReassociateTransformer end
+} // namespace sc
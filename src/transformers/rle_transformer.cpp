@@ -0,0 +1,86 @@
+#include "transformers/rle_transformer.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// RLETransformer begin
+void RLETransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    aa.Analyze();
+    mssa.Analyze();
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+
+    std::vector<Block *> stack = {func->GetBlock(0)};
+    while (!stack.empty()) {
+        auto *block = stack.back();
+        stack.pop_back();
+        for (auto *succ : dom->GetDTreeSuccessor(block)) {
+            stack.push_back(succ);
+        }
+
+        std::vector<size_t> remove;
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() != Opcode::LOAD) {
+                continue;
+            }
+
+            if (auto *value = FindValue(instr)) {
+#ifdef PRINT_DEBUG
+                instr->Dump(std::cerr << "  Replacing: ");
+                std::cerr << "    with: " << value->GetName() << "\n";
+#endif
+                ReplaceUses(instr->GetDest(), value);
+                remove.push_back(instr->GetIndex());
+            }
+        }
+        block->RemoveInstructions(std::move(remove), true);
+    }
+
+    Statistics::Get().Add("rle.forwarded", forwarded);
+    Statistics::Get().Add("rle.redundant", redundant);
+}
+
+OperandBase *RLETransformer::FindValue(InstructionBase *load) {
+    auto *access = mssa.GetAccess(load);
+    if (!access->defining) {
+        // Unreachable
+        return nullptr;
+    }
+
+    auto *ptr = load->GetOperand(0);
+    auto *dest = load->GetDest();
+    auto *clobber = mssa.GetClobber(access, ptr, aa);
+
+    // Store-to-load forwarding
+    if (clobber->kind == MemoryAccess::Kind::DEF &&
+        clobber->instr->GetOpcode() == Opcode::STORE &&
+        aa.MustAlias(clobber->instr->GetOperand(0), ptr)) {
+        auto *value = clobber->instr->GetOperand(1);
+        if (value->GetType() == dest->GetType()) {
+            ++forwarded;
+            return value;
+        }
+        return nullptr;
+    }
+
+    auto &loads = available[clobber];
+    for (auto *prev : loads) {
+        if (aa.MustAlias(prev->GetOperand(0), ptr) &&
+            mssa.Dominates(prev, load)) {
+            ++redundant;
+            return prev->GetDest();
+        }
+    }
+    loads.push_back(load);
+    return nullptr;
+}
+// RLETransformer end
+} // namespace sc
@@ -0,0 +1,164 @@
+#include "transformers/sroa_transformer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <format>
+#include <map>
+#include <memory>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// SROATransformer begin
+void SROATransformer::Transform() {
+    std::vector<InstructionBase *> allocs;
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->HasDest()) {
+                defs[instr->GetDest()].push_back(instr);
+            }
+            for (auto *op : instr->GetOperands()) {
+                uses[op].push_back(instr);
+            }
+            if (instr->GetOpcode() == Opcode::ALLOC) {
+                allocs.push_back(instr);
+            }
+        }
+    }
+
+    std::vector<Accesses> candidates;
+    for (auto *alloc : allocs) {
+        if (auto accesses = Collect(alloc)) {
+            candidates.push_back(std::move(*accesses));
+        }
+    }
+    // Every candidate was checked on the original code, their accesses
+    // are disjoint
+    for (auto &accesses : candidates) {
+        Promote(accesses);
+    }
+
+    Statistics::Get().Add("sroa.promoted", promoted);
+}
+
+std::optional<int64_t> SROATransformer::GetConstant(OperandBase *op) const {
+    auto it = defs.find(op);
+    if (it == defs.end() || it->second.size() != 1 ||
+        it->second[0]->GetOpcode() != Opcode::CONST ||
+        op->GetType() != DataType::INT) {
+        return std::nullopt;
+    }
+    return static_cast<IntOperand *>(it->second[0]->GetOperand(0))->GetValue();
+}
+
+bool SROATransformer::IsAssignedOnce(OperandBase *op) const {
+    auto it = defs.find(op);
+    return it != defs.end() && it->second.size() == 1;
+}
+
+std::optional<SROATransformer::Accesses>
+SROATransformer::Collect(InstructionBase *alloc) const {
+    auto size = GetConstant(alloc->GetOperand(0));
+    if (!size || *size < 1 || *size > max_elements ||
+        !IsAssignedOnce(alloc->GetDest())) {
+        return std::nullopt;
+    }
+
+    Accesses accesses;
+    accesses.removed.push_back(alloc);
+    std::vector<std::pair<OperandBase *, int64_t>> worklist = {
+        {alloc->GetDest(), 0}};
+    while (!worklist.empty()) {
+        auto [ptr, offset] = worklist.back();
+        worklist.pop_back();
+        auto it = uses.find(ptr);
+        if (it == uses.end()) {
+            continue;
+        }
+
+        for (auto *use : it->second) {
+            auto opcode = use->GetOpcode();
+            if (opcode == Opcode::LOAD ||
+                (opcode == Opcode::STORE && use->GetOperand(1) != ptr)) {
+                if (offset < 0 || offset >= *size) {
+                    return std::nullopt;
+                }
+                accesses.memory.emplace_back(use, offset);
+            } else if (opcode == Opcode::FREE && offset == 0) {
+                accesses.removed.push_back(use);
+            } else if (opcode == Opcode::ID && IsAssignedOnce(use->GetDest())) {
+                accesses.removed.push_back(use);
+                worklist.emplace_back(use->GetDest(), offset);
+            } else if (opcode == Opcode::PTRADD && use->GetOperand(0) == ptr &&
+                       use->GetOperand(1) != ptr &&
+                       IsAssignedOnce(use->GetDest())) {
+                auto index = GetConstant(use->GetOperand(1));
+                if (!index) {
+                    return std::nullopt;
+                }
+                accesses.removed.push_back(use);
+                worklist.emplace_back(use->GetDest(), offset + *index);
+            } else {
+                // Escapes
+                return std::nullopt;
+            }
+        }
+    }
+
+    auto *block = alloc->GetBlock();
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    if (loops->GetLoopDepth(block)) {
+        auto after = [alloc, block](InstructionBase *instr) {
+            return instr->GetBlock() == block &&
+                   instr->GetIndex() >= alloc->GetIndex();
+        };
+        if (!std::ranges::all_of(accesses.removed, after) ||
+            !std::ranges::all_of(accesses.memory, after,
+                                 &std::pair<InstructionBase *, int64_t>::first)) {
+            return std::nullopt;
+        }
+    }
+    return accesses;
+}
+
+void SROATransformer::Promote(const Accesses &accesses) {
+#ifdef PRINT_DEBUG
+    accesses.removed[0]->Dump(std::cerr << "  Promoting: ");
+#endif
+    auto prefix = std::format("__sc_sroa{}.", count++);
+    std::map<int64_t, std::shared_ptr<OperandBase>> vars;
+    for (auto [instr, element] : accesses.memory) {
+        auto &var = vars[element];
+        auto is_load = instr->GetOpcode() == Opcode::LOAD;
+        if (!var) {
+            var = is_load ? instr->GetDest()->Clone()
+                          : instr->GetOperand(1)->Clone();
+            var->SetName(prefix + std::to_string(element));
+        }
+
+        auto copy = std::make_unique<IdInstruction>();
+        if (is_load) {
+            copy->AddDest(instr->CopyDest());
+            copy->SetOperand(var.get());
+        } else {
+            copy->AddDest(var);
+            copy->SetOperand(instr->GetOperand(1));
+        }
+        instr->GetBlock()->AddInstruction(std::move(copy), instr->GetIndex());
+    }
+
+    std::map<Block *, std::vector<size_t>> remove;
+    for (auto *instr : accesses.removed) {
+        remove[instr->GetBlock()].push_back(instr->GetIndex());
+    }
+    for (auto &[block, indexes] : remove) {
+        std::ranges::sort(indexes);
+        block->RemoveInstructions(std::move(indexes));
+    }
+    ++promoted;
+}
+// SROATransformer end
+} // namespace sc
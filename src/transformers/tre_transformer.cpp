@@ -0,0 +1,170 @@
+#include "transformers/tre_transformer.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <format>
+#include <ranges>
+#include <unordered_set>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// TRETransformer begin
+void TRETransformer::Transform() {
+    // Jumps to the entry would run the loop header twice
+    if (func->GetBlock(0)->GetPredecessorSize()) {
+        return;
+    }
+
+    std::vector<CallInstruction *> calls;
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == Opcode::CALL &&
+                IsTailCall(static_cast<CallInstruction *>(instr))) {
+                calls.push_back(static_cast<CallInstruction *>(instr));
+            }
+        }
+    }
+    if (calls.empty()) {
+        return;
+    }
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+
+    auto *header = SplitEntry();
+    for (auto *call : calls) {
+        Eliminate(call, header);
+    }
+
+    Statistics::Get().Add("tre.calls", calls.size());
+}
+
+bool TRETransformer::IsTailCall(CallInstruction *call) const {
+    if (call->GetFuncName() != func->GetName() ||
+        call->GetOperandSize() != func->GetArgsSize()) {
+        return false;
+    }
+
+    // Copies of the value and jumps, like the ones to the unique exit
+    // block, may come before the ret
+    auto *value = call->HasDest() ? call->GetDest() : nullptr;
+    auto *block = call->GetBlock();
+    auto i = call->GetIndex() + 1;
+    std::unordered_set<Block *> visited{block};
+    while (i < block->GetInstructionSize()) {
+        auto *instr = block->GetInstruction(i++);
+        if (instr->GetOpcode() == Opcode::ID && value &&
+            instr->GetOperand(0) == value) {
+            value = instr->GetDest();
+        } else if (instr->GetOpcode() == Opcode::JMP) {
+            block = static_cast<JmpInstruction *>(instr)
+                        ->GetJmpDest()
+                        ->GetBlock();
+            if (!visited.insert(block).second) {
+                return false;
+            }
+            i = 0;
+        } else if (instr->GetOpcode() == Opcode::RET) {
+            return func->GetRetType() == DataType::VOID ||
+                   instr->GetOperand(0) == value;
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+Block *TRETransformer::SplitEntry() {
+    auto *entry = func->GetBlock(0);
+    auto name = std::string("__sc_tre.header");
+    auto new_block = std::make_unique<Block>(name);
+    auto label = std::make_unique<LabelOperand>(name);
+    label->SetBlock(new_block.get());
+    new_block->SetLabel(std::move(label));
+    auto *header = new_block.get();
+
+    auto args = func->GetArgsSize();
+    while (entry->GetInstructionSize() > args) {
+        header->AddInstruction(entry->ReleaseInstruction(args));
+    }
+    for (auto *succ : entry->GetSuccessors()) {
+        header->AddSuccessor(succ);
+        succ->RemovePredecessor(entry);
+        succ->AddPredecessor(header);
+    }
+    while (entry->GetSuccessorSize()) {
+        entry->RemoveSuccessor(entry->GetSuccessorSize() - 1);
+    }
+    func->InsertBlock(std::move(new_block), 1);
+
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(header->GetLabel());
+    entry->AddInstruction(std::move(jmp_instr));
+    entry->AddSuccessor(header);
+    header->AddPredecessor(entry);
+    return header;
+}
+
+void TRETransformer::Eliminate(CallInstruction *call, Block *header) {
+#ifdef PRINT_DEBUG
+    call->Dump(std::cerr << "  Eliminating: ");
+#endif
+    auto *block = call->GetBlock();
+    auto *entry = func->GetBlock(0);
+
+    // Every argument is read before any parameter is written, since an
+    // argument may be another parameter
+    std::vector<std::unique_ptr<InstructionBase>> reads;
+    std::vector<std::unique_ptr<InstructionBase>> writes;
+    for (auto k : std::views::iota(0ul, func->GetArgsSize())) {
+        auto *param = entry->GetInstruction(k);
+        assert(param->GetOpcode() == Opcode::GETARG);
+        auto *arg = call->GetOperand(k);
+        if (arg == param->GetDest()) {
+            continue;
+        }
+
+        auto temp = param->GetDest()->Clone();
+        temp->SetName(std::format("__sc_tre.{}", count++));
+        auto read = std::make_unique<IdInstruction>();
+        read->AddDest(temp);
+        read->SetOperand(arg);
+        reads.push_back(std::move(read));
+
+        auto write = std::make_unique<IdInstruction>();
+        write->AddDest(param->CopyDest());
+        write->SetOperand(temp.get());
+        writes.push_back(std::move(write));
+    }
+
+    auto idx = call->GetIndex();
+    while (block->GetInstructionSize() > idx) {
+        block->RemoveInstruction(block->GetInstructionSize() - 1);
+    }
+    for (auto &instr : reads) {
+        block->AddInstruction(std::move(instr));
+    }
+    for (auto &instr : writes) {
+        block->AddInstruction(std::move(instr));
+    }
+
+    // The block jumped to the exit
+    for (auto *succ : block->GetSuccessors()) {
+        succ->RemovePredecessor(block);
+    }
+    while (block->GetSuccessorSize()) {
+        block->RemoveSuccessor(block->GetSuccessorSize() - 1);
+    }
+
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(header->GetLabel());
+    block->AddInstruction(std::move(jmp_instr));
+    block->AddSuccessor(header);
+    header->AddPredecessor(block);
+}
+// TRETransformer end
+} // namespace sc
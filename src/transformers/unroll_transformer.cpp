@@ -0,0 +1,426 @@
+#include "transformers/unroll_transformer.hpp"
+#include "analyzers/dominator_analyzer.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include "transformers/cf_transformer.hpp"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+// Limits on the number of instructions produced by unrolling a loop
+static constexpr size_t max_full_size = 128;
+static constexpr size_t max_partial_size = 128;
+static constexpr size_t max_trip_count = 16;
+
+static bool Compare(Opcode opcode, ValType::INT a, ValType::INT b) {
+    switch (opcode) {
+    case Opcode::LT:
+        return a < b;
+    case Opcode::LE:
+        return a <= b;
+    case Opcode::GT:
+        return a > b;
+    case Opcode::GE:
+        return a >= b;
+    default:
+        assert(false && "Compare - Unexpected Opcode found\n");
+        return false;
+    }
+}
+
+static std::unique_ptr<Block> MakeBlock(const std::string &name) {
+    auto block = std::make_unique<Block>(name);
+    auto label = std::make_unique<LabelOperand>(name);
+    label->SetBlock(block.get());
+    block->SetLabel(std::move(label));
+    return block;
+}
+
+// UnrollTransformer begin
+size_t UnrollTransformer::factor = 4;
+
+void UnrollTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+
+    // All the loops are inspected before the CFG is changed
+    std::vector<CountedLoop> counted;
+    for (auto *loop : loops->GetLoopsInnermostFirst()) {
+        if (!loop->GetSubLoops().empty()) {
+            continue;
+        }
+        if (auto cl = GetCountedLoop(loop)) {
+            counted.push_back(*cl);
+        }
+    }
+
+    size_t full = 0, partial = 0;
+    for (auto &cl : counted) {
+        if (cl.trip_count && *cl.trip_count &&
+            *cl.trip_count * cl.size <= max_full_size) {
+            FullUnroll(cl);
+            ++full;
+        } else if (factor > 1 && cl.size * factor <= max_partial_size) {
+            PartialUnroll(cl);
+            ++partial;
+        }
+    }
+
+    Statistics::Get().Add("unroll.full", full);
+    Statistics::Get().Add("unroll.partial", partial);
+
+    // Merges the copies and removes the preheaders that weren't needed
+    if (loops->GetLoopSize()) {
+        ApplyTransformation<CFTransformer>(func);
+    }
+}
+
+std::optional<UnrollTransformer::CountedLoop>
+UnrollTransformer::GetCountedLoop(Loop *loop) {
+    auto *header = loop->GetHeader();
+    if (!loop->GetPreheader() || loop->GetLatches().size() != 1 ||
+        loop->GetExits().size() != 1) {
+        return std::nullopt;
+    }
+
+    // The loop is only left from the header or the latch
+    auto *latch = loop->GetLatches()[0];
+    Block *exiting = nullptr;
+    size_t size = 0;
+    for (auto *block : loop->GetBlocks()) {
+        if (std::ranges::any_of(block->GetSuccessors(), [loop](Block *succ) {
+                return !loop->Contains(succ);
+            })) {
+            if (exiting) {
+                return std::nullopt;
+            }
+            exiting = block;
+        }
+        size += block->GetInstructionSize();
+    }
+
+    auto *br = LAST_INSTR(exiting);
+    if (br->GetOpcode() != Opcode::BR) {
+        return std::nullopt;
+    }
+    auto *next = static_cast<BranchInstruction *>(br)->GetTrueDest()->GetBlock();
+    auto *exit = static_cast<BranchInstruction *>(br)->GetFalseDest()->GetBlock();
+    // The loop goes on along the true edge and is left along the false one
+    if (!loop->Contains(next) || loop->Contains(exit)) {
+        return std::nullopt;
+    }
+
+    CountedLoop cl;
+    cl.loop = loop;
+    cl.exit = exit;
+    if (exiting == header && header->GetInstructionSize() == 2 &&
+        next != header) {
+        // while loop, the body is cloned without the header
+        cl.bottom_tested = false;
+        cl.entry = next;
+        cl.body.assign(loop->GetBlocks().begin() + 1, loop->GetBlocks().end());
+        size -= 2;
+    } else if (exiting == latch && next == header) {
+        // do-while loop, the whole loop is cloned
+        cl.bottom_tested = true;
+        cl.entry = header;
+        cl.body.assign(loop->GetBlocks().begin(), loop->GetBlocks().end());
+    } else {
+        return std::nullopt;
+    }
+    cl.size = size;
+
+    InstructionBase *cmp = nullptr;
+    for (auto *instr : exiting->GetInstructions()) {
+        if (instr->GetDest() == br->GetOperand(0)) {
+            cmp = instr;
+        }
+    }
+    if (!cmp || CountDefs(loop, cmp->GetDest()) != 1) {
+        return std::nullopt;
+    }
+    auto opcode = cmp->GetOpcode();
+    if (opcode != Opcode::LT && opcode != Opcode::LE &&
+        opcode != Opcode::GT && opcode != Opcode::GE) {
+        return std::nullopt;
+    }
+    cl.cmp = cmp;
+
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+    for (size_t pos : {0ul, 1ul}) {
+        auto *iv = cmp->GetOperand(pos);
+        auto *bound = cmp->GetOperand(1 - pos);
+        if (iv == bound || iv->GetType() != DataType::INT ||
+            CountDefs(loop, bound) || CountDefs(loop, iv) != 1) {
+            continue;
+        }
+
+        // The single update of the induction variable
+        InstructionBase *inc = nullptr;
+        for (auto *block : loop->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                if (instr->GetDest() == iv) {
+                    inc = instr;
+                }
+            }
+        }
+
+        OperandBase *step_op = nullptr;
+        if (inc->GetOpcode() == Opcode::ADD) {
+            if (inc->GetOperand(0) == iv) {
+                step_op = inc->GetOperand(1);
+            } else if (inc->GetOperand(1) == iv) {
+                step_op = inc->GetOperand(0);
+            }
+        } else if (inc->GetOpcode() == Opcode::SUB &&
+                   inc->GetOperand(0) == iv) {
+            step_op = inc->GetOperand(1);
+        }
+        if (!step_op || step_op == iv || CountDefs(loop, step_op)) {
+            continue;
+        }
+
+        auto step = GetEntryConstant(loop, step_op);
+        if (!step || !*step) {
+            continue;
+        }
+        if (inc->GetOpcode() == Opcode::SUB) {
+            *step = -*step;
+        }
+
+        // Updated exactly once per iteration
+        if (!dom->Dominates(inc->GetBlock(), latch)) {
+            continue;
+        }
+
+        // Once the comparison fails it must keep failing
+        bool less = opcode == Opcode::LT || opcode == Opcode::LE;
+        if ((pos == 0) != (less == (*step > 0))) {
+            continue;
+        }
+
+        // Whether cmp sees the iv before or after the update
+        bool before = inc->GetBlock() != exiting ||
+                      inc->GetIndex() < cmp->GetIndex();
+        cl.iv = iv;
+        cl.step = *step;
+        cl.offset = cl.bottom_tested && before ? *step : 0;
+
+        // A do-while loop runs the first iteration unconditionally
+        auto init = GetEntryConstant(loop, iv);
+        auto limit = GetEntryConstant(loop, bound);
+        if (init && limit) {
+            auto i = *init + cl.offset;
+            size_t count = cl.bottom_tested;
+            while (count <= max_trip_count &&
+                   (pos == 0 ? Compare(opcode, i, *limit)
+                             : Compare(opcode, *limit, i))) {
+                i += *step;
+                ++count;
+            }
+            if (count <= max_trip_count) {
+                cl.trip_count = count;
+            }
+        }
+
+#ifdef PRINT_DEBUG
+        std::cerr << "  Counted loop: " << header->GetName()
+                  << " iv: " << iv->GetName() << " step: " << *step << "\n";
+#endif
+        return cl;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<ValType::INT>
+UnrollTransformer::GetEntryConstant(Loop *loop, OperandBase *op) const {
+    // Last definition on the straight-line path ending at the preheader
+    std::unordered_set<Block *> visited;
+    auto *block = loop->GetPreheader();
+    while (block && visited.insert(block).second) {
+        for (auto i = block->GetInstructionSize(); i-- > 0;) {
+            auto *instr = block->GetInstruction(i);
+            if (instr->GetDest() != op) {
+                continue;
+            }
+            if (instr->GetOpcode() == Opcode::CONST &&
+                op->GetType() == DataType::INT) {
+                return static_cast<IntOperand *>(instr->GetOperand(0))
+                    ->GetValue();
+            }
+            return std::nullopt;
+        }
+        block = block->GetPredecessorSize() == 1 ? block->GetPredecessor(0)
+                                                  : nullptr;
+    }
+
+    // Otherwise the only definition in the function
+    InstructionBase *def = nullptr;
+    for (auto *blk : func->GetBlocks()) {
+        for (auto *instr : blk->GetInstructions()) {
+            if (instr->GetDest() == op) {
+                if (def) {
+                    return std::nullopt;
+                }
+                def = instr;
+            }
+        }
+    }
+    auto *dom = func->GetAnalysis<DominatorAnalyzer>();
+    if (def && def->GetOpcode() == Opcode::CONST &&
+        op->GetType() == DataType::INT &&
+        dom->Dominates(def->GetBlock(), loop->GetPreheader())) {
+        return static_cast<IntOperand *>(def->GetOperand(0))->GetValue();
+    }
+    return std::nullopt;
+}
+
+size_t UnrollTransformer::CountDefs(Loop *loop, OperandBase *op) const {
+    size_t count = 0;
+    for (auto *block : loop->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            count += instr->GetDest() == op;
+        }
+    }
+    return count;
+}
+
+void UnrollTransformer::FullUnroll(CountedLoop &cl) {
+    auto *header = cl.loop->GetHeader();
+    auto *latch = cl.loop->GetLatches()[0];
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__ << " " << header->GetName() << " x"
+              << *cl.trip_count << "\n";
+#endif
+
+    std::vector<std::unordered_map<Block *, Block *>> copies;
+    for (auto j : std::views::iota(0ul, *cl.trip_count)) {
+        copies.push_back(CloneBlocks(func, cl.body,
+                                     "__sc_ur" + std::to_string(j) + "_",
+                                     header->GetIndex()));
+    }
+
+    // The copies run one after the other and then leave the loop, which
+    // is unreachable from now on.
+    RedirectEdge(cl.loop->GetPreheader(), header, copies[0][cl.entry]);
+    RepeatTest(cl, copies);
+    for (auto j : std::views::iota(0ul, copies.size())) {
+        auto *from = copies[j][latch];
+        auto *to = j + 1 < copies.size() ? copies[j + 1][cl.entry] : cl.exit;
+        if (cl.bottom_tested) {
+            ReplaceWithJmp(from, to);
+            continue;
+        }
+
+        if (j + 1 == copies.size()) {
+            // The condition may be used after the loop
+            auto const_instr = std::make_unique<ConstInstruction>();
+            const_instr->AddDest(cl.cmp->CopyDest());
+            const_instr->SetOperand(BoolOperand::GetOperand(false));
+            from->InsertInstruction(std::move(const_instr),
+                                    from->GetInstructionSize() - 1);
+        }
+        RedirectEdge(from, header, to);
+    }
+}
+
+void UnrollTransformer::PartialUnroll(CountedLoop &cl) {
+    auto *header = cl.loop->GetHeader();
+    auto *latch = cl.loop->GetLatches()[0];
+    auto name = "__sc_ur_" + header->GetName();
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__ << " " << header->GetName() << " x"
+              << factor << "\n";
+#endif
+
+    // Checks that the comparison holds for the last of the unrolled
+    // iterations that must go on, hence for all of them. A do-while loop
+    // doesn't test before its first iteration.
+    auto k = static_cast<ValType::INT>(factor) - cl.bottom_tested;
+    auto block = MakeBlock(name);
+    auto *check = block.get();
+
+    auto offset = std::make_shared<RegOperand>(DataType::INT, name + ".step");
+    auto const_instr = std::make_unique<ConstInstruction>();
+    const_instr->AddDest(offset);
+    const_instr->SetOperand(
+        IntOperand::GetOperand((k - 1) * cl.step + cl.offset));
+    check->AddInstruction(std::move(const_instr));
+
+    auto last = std::make_shared<RegOperand>(DataType::INT, name + ".iv");
+    auto add_instr = std::make_unique<AddInstruction>();
+    add_instr->AddDest(last);
+    add_instr->SetOperand(cl.iv);
+    add_instr->SetOperand(offset.get());
+    check->AddInstruction(std::move(add_instr));
+
+    auto cond = std::make_shared<RegOperand>(DataType::BOOL, name + ".cond");
+    auto cmp_instr = MakeInstruction(cl.cmp->GetOpcode());
+    cmp_instr->AddDest(cond);
+    for (auto *op : cl.cmp->GetOperands()) {
+        cmp_instr->SetOperand(op == cl.iv ? last.get() : op);
+    }
+    check->AddInstruction(std::move(cmp_instr));
+
+    func->InsertBlock(std::move(block), header->GetIndex());
+
+    std::vector<std::unordered_map<Block *, Block *>> copies;
+    for (auto j : std::views::iota(0ul, factor)) {
+        copies.push_back(CloneBlocks(func, cl.body,
+                                     "__sc_ur" + std::to_string(j) + "_",
+                                     header->GetIndex()));
+    }
+
+    auto br_instr = std::make_unique<BranchInstruction>();
+    br_instr->SetOperand(cond.get());
+    br_instr->SetTrueDest(copies[0][cl.entry]->GetLabel());
+    br_instr->SetFalseDest(header->GetLabel());
+    check->AddInstruction(std::move(br_instr));
+    check->AddSuccessor(copies[0][cl.entry]);
+    copies[0][cl.entry]->AddPredecessor(check);
+    check->AddSuccessor(header);
+    header->AddPredecessor(check);
+
+    // The original loop runs the remaining iterations. The last copy of a
+    // do-while loop keeps its test since the loop may end there.
+    RedirectEdge(cl.loop->GetPreheader(), header, check);
+    RepeatTest(cl, copies);
+    for (auto j : std::views::iota(0ul, copies.size())) {
+        auto *from = copies[j][latch];
+        if (j + 1 == copies.size()) {
+            RedirectEdge(from, cl.bottom_tested ? copies[j][header] : header,
+                         check);
+        } else if (cl.bottom_tested) {
+            ReplaceWithJmp(from, copies[j + 1][cl.entry]);
+        } else {
+            RedirectEdge(from, header, copies[j + 1][cl.entry]);
+        }
+    }
+}
+void UnrollTransformer::RepeatTest(
+    const CountedLoop &cl,
+    const std::vector<std::unordered_map<Block *, Block *>> &copies) {
+    if (cl.bottom_tested) {
+        return;
+    }
+
+    // The copies of a while loop skip its header, the body may still read
+    // the condition it assigned
+    for (auto &copy : copies) {
+        auto *entry = copy.at(cl.entry);
+        entry->InsertInstruction(CloneInstruction(cl.cmp), 0);
+    }
+}
+// UnrollTransformer end
+} // namespace sc
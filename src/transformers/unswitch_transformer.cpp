@@ -0,0 +1,185 @@
+#include "transformers/unswitch_transformer.hpp"
+#include "statistics.hpp"
+#include "transformers/cf_transformer.hpp"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+
+namespace sc {
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+// Limits on the instructions of an unswitched loop and on the instructions
+// cloned in a function
+static constexpr size_t max_loop_size = 64;
+static constexpr size_t max_growth = 256;
+
+static size_t GetSize(Loop *loop) {
+    size_t size = 0;
+    for (auto *block : loop->GetBlocks()) {
+        size += block->GetInstructionSize();
+    }
+    return size;
+}
+
+// UnswitchTransformer begin
+void UnswitchTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function:  " << func->GetName() << "\n";
+#endif
+    auto *loops = func->GetAnalysis<LoopAnalyzer>();
+    dom = func->GetAnalysis<DominatorAnalyzer>();
+
+    // Outer loops first, the chosen loops are disjoint so they can be
+    // unswitched once all of them are known.
+    auto order = loops->GetLoopsInnermostFirst();
+    std::ranges::reverse(order);
+
+    std::vector<std::pair<Loop *, BranchInstruction *>> chosen;
+    std::unordered_set<Loop *> unswitched;
+    size_t growth = 0;
+    for (auto *loop : order) {
+        bool nested = false;
+        for (auto *parent = loop->GetParent(); parent;
+             parent = parent->GetParent()) {
+            nested |= unswitched.contains(parent);
+        }
+
+        auto size = GetSize(loop);
+        if (nested || size > max_loop_size || growth + size > max_growth) {
+            continue;
+        }
+
+        if (auto *br = FindInvariantBranch(loop)) {
+            chosen.push_back({loop, br});
+            unswitched.insert(loop);
+            growth += size;
+        }
+    }
+
+    for (auto i : std::views::iota(0ul, chosen.size())) {
+        Unswitch(chosen[i].first, chosen[i].second, i);
+    }
+
+    Statistics::Get().Add("unswitch.loops", chosen.size());
+
+    // Removes the dead side of each version
+    if (loops->GetLoopSize()) {
+        ApplyTransformation<CFTransformer>(func);
+    }
+}
+
+BranchInstruction *UnswitchTransformer::FindInvariantBranch(Loop *loop) const {
+    std::unordered_set<OperandBase *> defs;
+    for (auto *block : loop->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetDest()) {
+                defs.insert(instr->GetDest());
+            }
+        }
+    }
+
+    for (auto *block : loop->GetBlocks()) {
+        auto *instr = LAST_INSTR(block);
+        if (instr->GetOpcode() != Opcode::BR) {
+            continue;
+        }
+
+        auto *br = static_cast<BranchInstruction *>(instr);
+        auto *cond = br->GetOperand(0);
+        if (br->GetTrueDest() != br->GetFalseDest() && !defs.contains(cond) &&
+            IsDefinedAt(cond, loop->GetPreheader()) &&
+            CanExit(loop, block, br->GetTrueDest()->GetBlock()) &&
+            CanExit(loop, block, br->GetFalseDest()->GetBlock())) {
+            return br;
+        }
+    }
+    return nullptr;
+}
+
+bool UnswitchTransformer::IsDefinedAt(OperandBase *op, Block *block) const {
+    // The preheader now reads the condition, which must not be undefined
+    // on a path that never reached the branch.
+    for (auto *blk : func->GetBlocks()) {
+        if (!dom->Dominates(blk, block)) {
+            continue;
+        }
+        for (auto *instr : blk->GetInstructions()) {
+            if (instr->GetDest() == op) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool UnswitchTransformer::CanExit(Loop *loop, Block *block,
+                                  Block *taken) const {
+    // A version that never leaves the loop has no post-dominator for its
+    // blocks, which DCE relies on.
+    std::vector<Block *> worklist = {loop->GetHeader()};
+    std::unordered_set<Block *> visited = {loop->GetHeader()};
+    while (!worklist.empty()) {
+        auto *blk = worklist.back();
+        worklist.pop_back();
+        if (!loop->Contains(blk) ||
+            LAST_INSTR(blk)->GetOpcode() == Opcode::RET) {
+            return true;
+        }
+
+        std::vector<Block *> succs = {taken};
+        if (blk != block) {
+            succs.assign(blk->GetSuccessors().begin(),
+                         blk->GetSuccessors().end());
+        }
+        for (auto *succ : succs) {
+            if (visited.insert(succ).second) {
+                worklist.push_back(succ);
+            }
+        }
+    }
+    return false;
+}
+
+void UnswitchTransformer::Unswitch(Loop *loop, BranchInstruction *br,
+                                   size_t id) {
+    auto *header = loop->GetHeader();
+    auto *preheader = loop->GetPreheader();
+    auto *block = br->GetBlock();
+
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__ << " " << header->GetName()
+              << " on: " << br->GetOperand(0)->GetName() << "\n";
+#endif
+
+    // The clone is the version where the condition is false
+    auto clones = CloneBlocks(func, loop->GetBlocks(),
+                              "__sc_us" + std::to_string(id) + "_",
+                              header->GetIndex());
+
+    assert(LAST_INSTR(preheader)->GetOpcode() == Opcode::JMP);
+    preheader->RemoveInstruction(preheader->GetInstructionSize() - 1);
+    preheader->RemoveSuccessor(header);
+    header->RemovePredecessor(preheader);
+
+    auto br_instr = std::make_unique<BranchInstruction>();
+    br_instr->SetOperand(br->GetOperand(0));
+    br_instr->SetTrueDest(header->GetLabel());
+    br_instr->SetFalseDest(clones[header]->GetLabel());
+    preheader->AddInstruction(std::move(br_instr));
+    preheader->AddSuccessor(header);
+    header->AddPredecessor(preheader);
+    preheader->AddSuccessor(clones[header]);
+    clones[header]->AddPredecessor(preheader);
+
+    auto *clone = clones[block];
+    auto *false_dest = static_cast<BranchInstruction *>(LAST_INSTR(clone))
+                           ->GetFalseDest()
+                           ->GetBlock();
+    ReplaceWithJmp(block, br->GetTrueDest()->GetBlock());
+    ReplaceWithJmp(clone, false_dest);
+}
+// UnswitchTransformer end
+} // namespace sc
@@ -0,0 +1,167 @@
+#include "transformers/vrp_transformer.hpp"
+#include "analyzers/cfg.hpp"
+#include "opcodes.hpp"
+#include "operand.hpp"
+#include "statistics.hpp"
+#include <memory>
+#include <unordered_set>
+
+// #define PRINT_DEBUG
+#undef PRINT_DEBUG
+
+namespace sc {
+// VRPTransformer begin
+void VRPTransformer::Transform() {
+#ifdef PRINT_DEBUG
+    std::cerr << __PRETTY_FUNCTION__
+              << " Processing Function: " << func->GetName() << "\n";
+#endif
+    ra.Analyze();
+#ifdef PRINT_DEBUG
+    ra.DumpRanges(std::cerr);
+#endif
+
+    for (auto *block : func->GetBlocks()) {
+        if (ra.IsExecutable(block)) {
+            Fold(block);
+            FoldBranch(block);
+        }
+    }
+    RemoveUnreachable();
+
+    Statistics::Get().Add("vrp.folded", folded);
+    Statistics::Get().Add("vrp.branches", branches);
+    Statistics::Get().Add("vrp.blocks", blocks);
+}
+
+void VRPTransformer::Fold(Block *block) {
+    std::vector<InstructionBase *> constants;
+    for (auto *instr : block->GetInstructions()) {
+        switch (instr->GetOpcode()) {
+        case Opcode::ADD:
+        case Opcode::SUB:
+        case Opcode::MUL:
+        case Opcode::DIV:
+        case Opcode::EQ:
+        case Opcode::LT:
+        case Opcode::LE:
+        case Opcode::GT:
+        case Opcode::GE:
+        case Opcode::AND:
+        case Opcode::OR:
+        case Opcode::NOT:
+        case Opcode::ID:
+        case Opcode::GET:
+            if (auto range = ra.GetRange(instr->GetDest());
+                range && range->IsConstant()) {
+                constants.push_back(instr);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (auto *instr : constants) {
+#ifdef PRINT_DEBUG
+        instr->Dump(std::cerr << "  Folding: ");
+#endif
+        if (instr->GetOpcode() == Opcode::GET) {
+            for (auto *seti : static_cast<GetInstruction *>(instr)->GetSetPairs()) {
+                seti->GetBlock()->RemoveInstruction(seti->GetIndex(), true);
+            }
+        }
+
+        auto value = ra.GetRange(instr->GetDest())->lo;
+        auto const_instr = std::make_unique<ConstInstruction>();
+        if (instr->GetDest()->GetType() == DataType::INT) {
+            SetOperandAndUse(const_instr.get(), IntOperand::GetOperand(value));
+        } else {
+            SetOperandAndUse(const_instr.get(),
+                             BoolOperand::GetOperand(value != 0));
+        }
+        SetDestAndDef(const_instr.get(), instr->ReleaseDest());
+        block->AddInstruction(std::move(const_instr), instr->GetIndex(), true);
+        ++folded;
+    }
+}
+
+void VRPTransformer::FoldBranch(Block *block) {
+    auto *last = LAST_INSTR(block);
+    if (last->GetOpcode() != Opcode::BR) {
+        return;
+    }
+
+    auto *br = static_cast<BranchInstruction *>(last);
+    auto *true_blk = br->GetTrueDest()->GetBlock();
+    auto *false_blk = br->GetFalseDest()->GetBlock();
+    auto to_true = ra.IsExecutable(block, true_blk);
+    if (true_blk == false_blk || to_true == ra.IsExecutable(block, false_blk)) {
+        return;
+    }
+
+    auto *target = to_true ? true_blk : false_blk;
+    auto *dropped = to_true ? false_blk : true_blk;
+#ifdef PRINT_DEBUG
+    std::cerr << "  Branch of " << block->GetName() << " always to "
+              << target->GetName() << "\n";
+#endif
+
+    // The sets for the gets of the dropped successor
+    std::vector<size_t> remove;
+    for (auto *instr : block->GetInstructions()) {
+        if (instr->GetOpcode() != Opcode::SET) {
+            continue;
+        }
+        auto *seti = static_cast<SetInstruction *>(instr);
+        if (seti->GetGetPair()->GetBlock() == dropped) {
+            seti->GetGetPair()->RemoveSetPair(seti);
+            remove.push_back(seti->GetIndex());
+        }
+    }
+
+    auto jmp_instr = std::make_unique<JmpInstruction>();
+    jmp_instr->SetJmpDest(target->GetLabel());
+    block->AddInstruction(std::move(jmp_instr), last->GetIndex(), true);
+    block->RemoveInstructions(std::move(remove), true);
+
+    block->RemoveSuccessor(dropped);
+    dropped->RemovePredecessor(block);
+    ++branches;
+}
+
+void VRPTransformer::RemoveUnreachable() {
+    // Blocks whose branch wasn't folded stay even if the ranges say they
+    // are never executed
+    auto cfg = ForwardCFG(func);
+    auto rpo = GetReversePostOrder(&cfg);
+    std::unordered_set<Block *> reachable(rpo.begin(), rpo.end());
+
+    std::vector<size_t> remove;
+    for (auto *block : func->GetBlocks()) {
+        if (reachable.contains(block)) {
+            continue;
+        }
+
+        for (auto *instr : block->GetInstructions()) {
+            for (auto *op : instr->GetOperands()) {
+                op->RemoveUse(instr);
+            }
+            if (instr->GetOpcode() == Opcode::SET) {
+                auto *seti = static_cast<SetInstruction *>(instr);
+                seti->GetGetPair()->RemoveSetPair(seti);
+            }
+        }
+        for (auto *succ : block->GetSuccessors()) {
+            succ->RemovePredecessor(block);
+        }
+        remove.push_back(block->GetIndex());
+    }
+
+    blocks += remove.size();
+    if (!remove.empty()) {
+        func->RemoveBlocks(std::move(remove));
+    }
+}
+// VRPTransformer end
+} // namespace sc
@@ -0,0 +1,11 @@
+#!/usr/bin/bash
+
+# Compares the time to parse the JSON of a program against the time
+# to load its binary IR snapshot taken right after parsing.
+for f in `find . -name *.bril`; do
+    bril2json < $f > /tmp/bench.json
+    ../build/sc --emit-ir /tmp/bench.scir --emit-after parse /tmp/bench.json
+    parse=$(../build/sc --time /tmp/bench.json 2>&1 >/dev/null)
+    load=$(../build/sc --time --load-ir /tmp/bench.scir 2>&1 >/dev/null)
+    echo "$f: $parse, $load"
+done
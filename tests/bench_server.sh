@@ -0,0 +1,21 @@
+#!/usr/bin/bash
+
+# Compares the latency of compiling every test program with a cold sc
+# process against sending it to a resident server through the client.
+SOCK=/tmp/sc_bench.sock
+../build/sc --serve $SOCK &
+SERVER=$!
+sleep 0.5
+
+for f in `find . -name *.bril`; do
+    bril2json < $f > /tmp/bench.json
+    start=$(date +%s%N)
+    ../build/sc /tmp/bench.json > /dev/null
+    cold=$((($(date +%s%N) - start) / 1000))
+    start=$(date +%s%N)
+    SC_SERVER=$SOCK ../build/sc /tmp/bench.json > /dev/null
+    warm=$((($(date +%s%N) - start) / 1000))
+    echo "$f: cold ${cold}us, server ${warm}us"
+done
+
+kill $SERVER
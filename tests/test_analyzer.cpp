@@ -1,7 +1,18 @@
+#include "analyzers/alias_analyzer.hpp"
+#include "analyzers/call_graph_analyzer.hpp"
 #include "analyzers/dominator_analyzer.hpp"
+#include "analyzers/induction_analyzer.hpp"
+#include "analyzers/lifetime_analyzer.hpp"
+#include "analyzers/loop_analyzer.hpp"
+#include "analyzers/memory_ssa_analyzer.hpp"
+#include "analyzers/range_analyzer.hpp"
+#include "analyzers/summary_analyzer.hpp"
 #include "function.hpp"
+#include "statistics.hpp"
 #include "test_utils.hpp"
 #include "transformers/cf_transformer.hpp"
+#include "transformers/hoist_alloc_transformer.hpp"
+#include "transformers/ssa_transformer.hpp"
 #include "transformers/transformer.hpp"
 #include <gtest/gtest.h>
 #include <ranges>
@@ -159,3 +170,509 @@ TEST(DominatorAnalyzerTest, TestPalindrome) {
     BUILD_CFG()
     DOM_ANALYSIS()
 }
+
+TEST(LoopAnalyzerTest, Test1dconv) {
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+
+    // convolve
+    auto *func = program->GetFunction(1);
+    auto *loops = func->GetAnalysis<sc::LoopAnalyzer>();
+    EXPECT_EQ(loops->GetLoopSize(), 2);
+    ASSERT_EQ(loops->GetTopLevelLoops().size(), 1);
+
+    auto *outer = loops->GetTopLevelLoops()[0];
+    EXPECT_EQ(outer->GetHeader()->GetName(), "outer.for.cond");
+    EXPECT_EQ(outer->GetPreheader(), func->GetBlock(0));
+    EXPECT_EQ(outer->GetBlocks().size(), 5);
+    ASSERT_EQ(outer->GetLatches().size(), 1);
+    EXPECT_EQ(outer->GetLatches()[0]->GetName(), "outer.for.end");
+    ASSERT_EQ(outer->GetExits().size(), 1);
+    EXPECT_EQ(outer->GetExits()[0]->GetName(), "return");
+
+    ASSERT_EQ(outer->GetSubLoops().size(), 1);
+    auto *inner = outer->GetSubLoops()[0];
+    EXPECT_EQ(inner->GetHeader()->GetName(), "inner.for.cond");
+    EXPECT_EQ(inner->GetPreheader()->GetName(), "outer.for.body");
+    EXPECT_EQ(inner->GetParent(), outer);
+    EXPECT_EQ(inner->GetDepth(), 2);
+    EXPECT_TRUE(outer->Contains(inner));
+    EXPECT_EQ(loops->GetLoopFor(inner->GetLatches()[0]), inner);
+    EXPECT_EQ(loops->GetLoopDepth(outer->GetLatches()[0]), 1);
+    EXPECT_EQ(loops->GetLoopDepth(func->GetBlock(0)), 0);
+
+    auto order = loops->GetLoopsInnermostFirst();
+    EXPECT_EQ(order, (std::vector<sc::Loop *>{inner, outer}));
+
+    // main has no loops
+    EXPECT_EQ(program->GetFunction(3)->GetAnalysis<sc::LoopAnalyzer>()
+                  ->GetLoopSize(),
+              0);
+}
+
+TEST(LoopAnalyzerTest, TestPreheader) {
+    READ_PROGRAM("../tests/bril/palindrome.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+
+    auto *func = program->GetFunction(0);
+    auto size = func->GetBlockSize();
+    auto *loops = func->GetAnalysis<sc::LoopAnalyzer>();
+    ASSERT_EQ(loops->GetLoopSize(), 1);
+    EXPECT_EQ(func->GetBlockSize(), size + 1);
+
+    // The only predecessor outside the loop ends with a branch
+    auto *loop = loops->GetTopLevelLoops()[0];
+    auto *header = loop->GetHeader();
+    auto *preheader = loop->GetPreheader();
+    EXPECT_EQ(preheader->GetName(), "__sc_ph_for.body");
+    EXPECT_EQ(preheader->GetIndex() + 1, header->GetIndex());
+    ASSERT_EQ(preheader->GetSuccessorSize(), 1);
+    EXPECT_EQ(preheader->GetSuccessor(0), header);
+    EXPECT_EQ(preheader->GetPredecessorSize(), 1);
+    EXPECT_EQ(header->GetPredecessorSize(), loop->GetLatches().size() + 1);
+    for (auto *pred : preheader->GetPredecessors()) {
+        EXPECT_FALSE(loop->Contains(pred));
+        EXPECT_NE(std::ranges::find(pred->GetSuccessors(), preheader),
+                  pred->GetSuccessors().end());
+    }
+
+    // Cached until a pass changes the CFG
+    EXPECT_EQ(func->GetAnalysis<sc::LoopAnalyzer>(), loops);
+    sc::ApplyTransformation<sc::CFTransformer>(func);
+    loops = func->GetAnalysis<sc::LoopAnalyzer>();
+    EXPECT_EQ(loops->GetLoopSize(), 1);
+    EXPECT_EQ(func->GetBlockSize(), size + 1);
+}
+
+TEST(InductionAnalyzerTest, Test1dconv) {
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    // convolve
+    auto *func = program->GetFunction(1);
+    auto *loops = func->GetAnalysis<sc::LoopAnalyzer>();
+    sc::InductionAnalyzer iva(func);
+    iva.Analyze();
+
+    auto names = [](const sc::InductionVariable &iv) {
+        std::vector<std::string> names;
+        for (auto *instr : iv.members) {
+            names.push_back(instr->GetDest()->GetName());
+        }
+        std::ranges::sort(names);
+        return names;
+    };
+
+    auto *outer = loops->GetTopLevelLoops()[0];
+    auto *inner = outer->GetSubLoops()[0];
+
+    // j and the kernel pointer step through the inner loop
+    auto &ivs = iva.GetInductionVariables(inner);
+    ASSERT_EQ(ivs.size(), 2);
+    std::vector<std::vector<std::string>> inner_ivs = {names(ivs[0]),
+                                                       names(ivs[1])};
+    std::ranges::sort(inner_ivs);
+    EXPECT_EQ(inner_ivs[0], (std::vector<std::string>{"j.3", "j.4"}));
+    EXPECT_EQ(inner_ivs[1],
+              (std::vector<std::string>{"kernelptr.3", "kernelptr.4"}));
+    for (auto &iv : ivs) {
+        EXPECT_EQ(iv.loop, inner);
+        for (auto *instr : iv.members) {
+            EXPECT_EQ(iva.GetInductionVariable(inner, instr->GetDest()), &iv);
+        }
+    }
+
+    // arrindex = i + j, arrptr = array + arrindex
+    auto &derived = iva.GetDerivedInductionVariables(inner);
+    ASSERT_EQ(derived.size(), 2);
+    EXPECT_EQ(derived[0].instr->GetOpcode(), sc::Opcode::ADD);
+    EXPECT_EQ(derived[0].iv->GetName(), "j.3");
+    EXPECT_EQ(derived[0].rc->GetName(), "i.1");
+    EXPECT_EQ(derived[1].instr->GetOpcode(), sc::Opcode::PTRADD);
+    EXPECT_EQ(derived[1].iv, derived[0].instr->GetDest());
+    EXPECT_EQ(derived[1].rc->GetName(), "array.0");
+
+    // The values of the inner loop aren't region constants of the outer
+    // one, only i and the output pointer step through it.
+    EXPECT_EQ(iva.GetInductionVariables(outer).size(), 2);
+    EXPECT_TRUE(iva.GetDerivedInductionVariables(outer).empty());
+    EXPECT_EQ(iva.GetInductionVariable(outer, derived[0].iv), nullptr);
+}
+
+TEST(CallGraphAnalyzerTest, TestRiemann) {
+    READ_PROGRAM("../tests/bril/riemann.json")
+    sc::CallGraphAnalyzer cg(program.get());
+    cg.Analyze();
+
+    auto *main = cg.GetFunction("main");
+    auto *square = cg.GetFunction("square_function");
+    ASSERT_NE(main, nullptr);
+    ASSERT_NE(square, nullptr);
+    EXPECT_EQ(cg.GetFunction("cube_function"), nullptr);
+
+    std::vector<std::string> callees;
+    for (auto *callee : cg.GetCallees(main)) {
+        callees.push_back(callee->GetName());
+    }
+    EXPECT_EQ(callees, (std::vector<std::string>{
+                           "left_riemann", "midpoint_riemann", "right_riemann"}));
+    EXPECT_EQ(cg.GetCalls(main).size(), 3);
+    EXPECT_TRUE(cg.GetCallees(square).empty());
+
+    // No recursion, every function is a component of its own and the
+    // callees come first
+    EXPECT_EQ(cg.GetSCCs().size(), program->GetSize());
+    EXPECT_EQ(cg.GetSCCIndex(square), 0);
+    EXPECT_EQ(cg.GetSCCIndex(main), program->GetSize() - 1);
+    for (auto &f : *program) {
+        for (auto *callee : cg.GetCallees(f.get())) {
+            EXPECT_LT(cg.GetSCCIndex(callee), cg.GetSCCIndex(f.get()));
+        }
+    }
+}
+
+TEST(CallGraphAnalyzerTest, TestAckermann) {
+    READ_PROGRAM("../tests/bril/ackermann.json")
+    sc::CallGraphAnalyzer cg(program.get());
+    cg.Analyze();
+
+    auto *ack = cg.GetFunction("ack");
+    auto *main = cg.GetFunction("main");
+    ASSERT_EQ(cg.GetCallees(ack).size(), 1);
+    EXPECT_EQ(cg.GetCallees(ack)[0], ack);
+    EXPECT_EQ(cg.GetCalls(ack).size(), 3);
+
+    ASSERT_EQ(cg.GetSCCs().size(), 2);
+    EXPECT_EQ(cg.GetSCCs()[0], (std::vector<sc::Function *>{ack}));
+    EXPECT_EQ(cg.GetSCCs()[1], (std::vector<sc::Function *>{main}));
+}
+
+TEST(CallGraphAnalyzerTest, TestOrders) {
+    READ_PROGRAM("../tests/bril/ackermann.json")
+    sc::CallGraphAnalyzer cg(program.get());
+    cg.Analyze();
+
+    auto *ack = cg.GetFunction("ack");
+    auto *main = cg.GetFunction("main");
+    EXPECT_TRUE(cg.IsRecursive(ack));
+    EXPECT_FALSE(cg.IsRecursive(main));
+    EXPECT_EQ(cg.GetBottomUpOrder(), (std::vector<sc::Function *>{ack, main}));
+    EXPECT_EQ(cg.GetTopDownOrder(), (std::vector<sc::Function *>{main, ack}));
+}
+
+TEST(SummaryAnalyzerTest, TestAckermann) {
+    READ_PROGRAM("../tests/bril/ackermann.json")
+    BUILD_CFG()
+    sc::SummaryAnalyzer summaries(program.get());
+    summaries.Analyze();
+
+    // The recursion may not terminate, a call of ack has to stay
+    auto &cg = summaries.GetCallGraph();
+    auto &ack = summaries.GetSummary(cg.GetFunction("ack"));
+    EXPECT_EQ(ack.effects, sc::FunctionSummary::DIVERGES);
+    EXPECT_FALSE(ack.IsPure());
+    EXPECT_TRUE(ack.HasSideEffects());
+    auto &main = summaries.GetSummary(cg.GetFunction("main"));
+    EXPECT_EQ(main.effects,
+              sc::FunctionSummary::PRINTS | sc::FunctionSummary::DIVERGES);
+    EXPECT_TRUE(main.HasSideEffects());
+}
+
+TEST(SummaryAnalyzerTest, TestGol) {
+    READ_PROGRAM("../tests/bril/gol.json")
+    BUILD_CFG()
+    sc::SummaryAnalyzer summaries(program.get());
+    summaries.Analyze();
+
+    auto &cg = summaries.GetCallGraph();
+    auto get = [&](const std::string &name) {
+        return summaries.GetSummary(cg.GetFunction(name));
+    };
+    EXPECT_TRUE(get("next_cell").IsPure());
+
+    // A div may trap on zero and a loop may not terminate
+    EXPECT_EQ(get("mod").effects, sc::FunctionSummary::DIVERGES);
+    EXPECT_TRUE(get("next_board").Has(sc::FunctionSummary::DIVERGES));
+
+    // Reads memory through loads that may trap
+    auto alive = get("alive");
+    EXPECT_EQ(alive.effects,
+              sc::FunctionSummary::READS | sc::FunctionSummary::DIVERGES);
+    EXPECT_FALSE(alive.IsPure());
+    EXPECT_TRUE(alive.HasSideEffects());
+
+    auto rand_array = get("rand_array");
+    EXPECT_TRUE(rand_array.Has(sc::FunctionSummary::ALLOCATES));
+    EXPECT_TRUE(rand_array.Has(sc::FunctionSummary::READS));
+    EXPECT_TRUE(rand_array.Has(sc::FunctionSummary::WRITES));
+    EXPECT_FALSE(rand_array.Has(sc::FunctionSummary::FREES));
+}
+
+TEST(SummaryAnalyzerTest, TestSummarizeCalls) {
+    READ_PROGRAM("../tests/bril/riemann.json")
+    sc::SummarizeCalls(program.get());
+
+    for (auto &f : *program) {
+        if (f->GetName() == "main") {
+            EXPECT_EQ(f->GetCalleeSummaries().size(), 3);
+            EXPECT_EQ(f->GetCalleeSummary("square_function"), nullptr);
+        } else if (f->GetName() == "left_riemann") {
+            auto *summary = f->GetCalleeSummary("square_function");
+            ASSERT_NE(summary, nullptr);
+            EXPECT_TRUE(summary->IsPure());
+        }
+    }
+}
+
+// Instruction defining the variable called name
+static sc::InstructionBase *FindDef(sc::Function *func,
+                                    const std::string &name) {
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->HasDest() && instr->GetDest()->GetName() == name) {
+                return instr;
+            }
+        }
+    }
+    return nullptr;
+}
+
+TEST(AliasAnalyzerTest, TestMem) {
+    READ_PROGRAM("../tests/bril/mem.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    auto *func = program->GetFunction(0);
+    sc::AliasAnalyzer aa(func);
+    aa.Analyze();
+
+    auto ptr = [func](const std::string &name) {
+        auto *def = FindDef(func, name);
+        EXPECT_NE(def, nullptr) << name;
+        return def->GetDest();
+    };
+    auto *v0 = ptr("v0.0");
+    auto *v1 = ptr("v1.0");
+    auto *vx = ptr("vx.0");
+    auto *ab = ptr("ab.0");
+
+    EXPECT_TRUE(aa.MustAlias(v0, v0));
+    EXPECT_FALSE(aa.MayAlias(v0, v1));
+    EXPECT_FALSE(aa.MayAlias(vx, v1));
+
+    // vx is stored into v1, so a pointer loaded back may be vx but can't
+    // be the allocations that never escape
+    EXPECT_TRUE(aa.IsEscaped(vx->GetDef()));
+    EXPECT_FALSE(aa.IsEscaped(v1->GetDef()));
+    EXPECT_EQ(aa.Alias(ab, vx), sc::AliasResult::MAY_ALIAS);
+    EXPECT_FALSE(aa.MayAlias(ab, v0));
+    EXPECT_FALSE(aa.MayAlias(ab, v1));
+
+    for (auto *block : func->GetBlocks()) {
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() != sc::Opcode::STORE) {
+                continue;
+            }
+            auto *dest = instr->GetOperand(0);
+            EXPECT_TRUE(aa.MayModify(instr, dest));
+            EXPECT_EQ(aa.MayModify(instr, ab), dest == vx);
+        }
+    }
+}
+
+TEST(AliasAnalyzerTest, Test1dconv) {
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    // convolve
+    auto *func = program->GetFunction(1);
+    sc::AliasAnalyzer aa(func);
+    aa.Analyze();
+
+    auto ptr = [func](const std::string &name) {
+        auto *def = FindDef(func, name);
+        EXPECT_NE(def, nullptr) << name;
+        return def->GetDest();
+    };
+    auto *output = ptr("output.0");
+    auto *outputptr = ptr("outputptr.1");
+    auto *kernelptr = ptr("kernelptr.3");
+    auto *arrptr = ptr("arrptr.0");
+
+    // The output is allocated after the arguments were passed
+    EXPECT_EQ(aa.GetOrigins(outputptr),
+              std::set<sc::InstructionBase *>{output->GetDef()});
+    EXPECT_FALSE(aa.MayAlias(outputptr, kernelptr));
+    EXPECT_FALSE(aa.MayAlias(outputptr, arrptr));
+    EXPECT_TRUE(aa.MayAlias(arrptr, kernelptr));
+
+    auto loc = sc::AliasAnalyzer::GetLocation(arrptr);
+    EXPECT_EQ(loc.root, ptr("array.0"));
+    EXPECT_FALSE(loc.offset.has_value());
+
+    // Storing the sum doesn't change the kernel and the array
+    auto *sum = FindDef(func, "storevalue.0");
+    auto *store = sum->GetBlock()->GetInstruction(sum->GetIndex() + 1);
+    ASSERT_EQ(store->GetOpcode(), sc::Opcode::STORE);
+    EXPECT_FALSE(aa.MayModify(store, kernelptr));
+    EXPECT_FALSE(aa.MayModify(store, arrptr));
+    EXPECT_TRUE(aa.MayModify(store, outputptr));
+    EXPECT_EQ(aa.Alias(store->GetOperand(0), outputptr),
+              sc::AliasResult::MUST_ALIAS);
+}
+
+TEST(MemorySSAAnalyzerTest, TestMem) {
+    READ_PROGRAM("../tests/bril/mem.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    auto *func = program->GetFunction(0);
+    sc::AliasAnalyzer aa(func);
+    aa.Analyze();
+    sc::MemorySSAAnalyzer mssa(func);
+    mssa.Analyze();
+
+    std::vector<sc::InstructionBase *> stores;
+    std::vector<sc::InstructionBase *> loads;
+    for (auto *block : func->GetBlocks()) {
+        EXPECT_EQ(mssa.GetPhi(block), nullptr);
+        for (auto *instr : block->GetInstructions()) {
+            if (instr->GetOpcode() == sc::Opcode::STORE) {
+                stores.push_back(instr);
+            } else if (instr->GetOpcode() == sc::Opcode::LOAD) {
+                loads.push_back(instr);
+            }
+        }
+    }
+    ASSERT_EQ(stores.size(), 3);
+    ASSERT_EQ(loads.size(), 3);
+
+    // Straight-line code, every access sees the write right above it
+    auto *first = mssa.GetAccess(stores[0]);
+    EXPECT_EQ(first->kind, sc::MemoryAccess::Kind::DEF);
+    EXPECT_EQ(first->defining, mssa.GetEntry());
+    auto *load = mssa.GetAccess(loads[0]);
+    EXPECT_EQ(load->kind, sc::MemoryAccess::Kind::USE);
+    EXPECT_EQ(load->defining, first);
+
+    // Storing false through vx doesn't change v1
+    auto *last = mssa.GetAccess(loads[2]);
+    EXPECT_EQ(last->defining, mssa.GetAccess(stores[2]));
+    EXPECT_EQ(mssa.GetClobber(last, loads[2]->GetOperand(0), aa),
+              mssa.GetAccess(stores[1]));
+}
+
+TEST(MemorySSAAnalyzerTest, Test1dconv) {
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    // convolve
+    auto *func = program->GetFunction(1);
+    sc::AliasAnalyzer aa(func);
+    aa.Analyze();
+    sc::MemorySSAAnalyzer mssa(func);
+    mssa.Analyze();
+
+    // The store of the sum makes both loop headers merge memory
+    auto *loops = func->GetAnalysis<sc::LoopAnalyzer>();
+    auto *outer = loops->GetTopLevelLoops()[0];
+    auto *inner = outer->GetSubLoops()[0];
+    auto *phi = mssa.GetPhi(inner->GetHeader());
+    ASSERT_NE(phi, nullptr);
+    EXPECT_EQ(phi->incoming.size(), 2);
+    EXPECT_NE(mssa.GetPhi(outer->GetHeader()), nullptr);
+
+    auto *kernelvalue = FindDef(func, "kernelvalue.0");
+    auto *currvalue = FindDef(func, "currvalue.0");
+    auto *access = mssa.GetAccess(kernelvalue);
+    EXPECT_EQ(access->defining, phi);
+    EXPECT_EQ(mssa.GetClobber(access, kernelvalue->GetOperand(0), aa), phi);
+    EXPECT_TRUE(mssa.Dominates(kernelvalue, currvalue));
+    EXPECT_FALSE(mssa.Dominates(currvalue, kernelvalue));
+}
+
+TEST(LifetimeAnalyzerTest, TestGol) {
+    READ_PROGRAM("../tests/bril/gol.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    for (auto &f : *program) {
+        sc::LifetimeAnalyzer lifetimes(f.get());
+        lifetimes.Analyze();
+        for (auto *block : f->GetBlocks()) {
+            for (auto *instr : block->GetInstructions()) {
+                if (instr->GetOpcode() != sc::Opcode::ALLOC) {
+                    continue;
+                }
+
+                // main frees what it allocates, rand_array returns it
+                auto freed = f->GetName() == "main";
+                EXPECT_EQ(lifetimes.IsFreedInFunction(instr), freed);
+                EXPECT_EQ(lifetimes.GetFrees(instr).size(), freed ? 1 : 0);
+            }
+        }
+    }
+}
+
+TEST(HoistAllocTransformerTest, TestAccount) {
+    READ_PROGRAM("../tests/bril/alloc.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    // Only counted with statistics enabled
+    auto &stats = sc::Statistics::Get();
+    stats.Reset();
+    program =
+        sc::ApplyTransformation<sc::HoistAllocTransformer>(std::move(program));
+    EXPECT_EQ(stats.GetCount("alloc.sites"), 0);
+
+    // main frees p, frees q on one path only, make returns r
+    stats.SetEnabled(true);
+    program =
+        sc::ApplyTransformation<sc::HoistAllocTransformer>(std::move(program));
+    stats.SetEnabled(false);
+    EXPECT_EQ(stats.GetCount("alloc.sites"), 3);
+    EXPECT_EQ(stats.GetCount("alloc.freed"), 1);
+    EXPECT_EQ(stats.GetCount("alloc.leaked"), 1);
+}
+
+TEST(RangeAnalyzerTest, Test1dconv) {
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+
+    for (auto &f : *program) {
+        sc::RangeAnalyzer ra(f.get());
+        ra.Analyze();
+        for (auto *block : f->GetBlocks()) {
+            EXPECT_TRUE(ra.IsExecutable(block));
+        }
+        if (f->GetName() != "genarray") {
+            continue;
+        }
+
+        // i counts up from 0 while it is less than size
+        auto max = std::numeric_limits<int64_t>::max();
+        auto *i1 = FindDef(f.get(), "i.1");
+        auto *i2 = FindDef(f.get(), "i.2");
+        EXPECT_EQ(ra.GetRange(i1->GetDest()), (sc::Range{0, max}));
+        EXPECT_EQ(ra.GetRange(i1->GetDest(), i2->GetBlock()),
+                  (sc::Range{0, max - 1}));
+        EXPECT_EQ(ra.GetRange(i2->GetDest()), (sc::Range{1, max}));
+        EXPECT_EQ(ra.GetRange(FindDef(f.get(), "one.0")->GetDest()),
+                  sc::Range::Of(1));
+        EXPECT_EQ(ra.GetRange(FindDef(f.get(), "cond.0")->GetDest()),
+                  (sc::Range{0, 1}));
+    }
+}
@@ -0,0 +1,86 @@
+#include "compile_cache.hpp"
+#include "statistics.hpp"
+#include "test_utils.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+static fs::path MakeCacheDir(const std::string &name) {
+    auto dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    return dir;
+}
+
+TEST(CacheTest, Hash) {
+    // Test vectors of the 128 bit FNV-1a
+    using Digest = sc::CompileCache::Digest;
+    EXPECT_EQ(sc::CompileCache::Hash(""),
+              (Digest{0x6c62272e07bb0142, 0x62b821756295c58d}));
+    EXPECT_EQ(sc::CompileCache::Hash("a"),
+              (Digest{0xd228cb696f1a8caf, 0x78912b704e4a8964}));
+    EXPECT_EQ(sc::CompileCache::Hash("foobar"),
+              (Digest{0x343e1662793c64bf, 0x6f0d3597ba446f18}));
+    EXPECT_EQ(sc::CompileCache::Hash("b", sc::CompileCache::Hash("a")),
+              sc::CompileCache::Hash("ab"));
+}
+
+TEST(CacheTest, StableKeys) {
+    auto dir = MakeCacheDir("sc_test_cache_keys");
+    sc::CompileCache cache(dir, "a", 1 << 20);
+    sc::CompileCache other(dir, "b", 1 << 20);
+
+    std::ifstream first("../tests/bril/gol.json");
+    auto a = sc::BrilParser::ParseProgram(first);
+    std::ifstream second("../tests/bril/gol.json");
+    auto b = sc::BrilParser::ParseProgram(second);
+
+    for (size_t i = 0; i < a->GetSize(); ++i) {
+        auto key = cache.GetKey(a->GetFunction(i));
+        EXPECT_EQ(key, cache.GetKey(b->GetFunction(i)));
+        EXPECT_NE(key, other.GetKey(b->GetFunction(i)));
+        if (i > 0) {
+            EXPECT_NE(key, cache.GetKey(a->GetFunction(i - 1)));
+        }
+    }
+    fs::remove_all(dir);
+}
+
+TEST(CacheTest, LookupAndStore) {
+    auto dir = MakeCacheDir("sc_test_cache_store");
+    sc::Statistics::Get().Reset();
+    {
+        sc::CompileCache cache(dir, "", 1 << 20);
+        EXPECT_FALSE(cache.Lookup("key"));
+        cache.Store("key", "@main {\n}\n");
+    }
+
+    // Entries survive across cache instances
+    sc::CompileCache cache(dir, "", 1 << 20);
+    auto text = cache.Lookup("key");
+    ASSERT_TRUE(text);
+    EXPECT_EQ(*text, "@main {\n}\n");
+    EXPECT_EQ(sc::Statistics::Get().GetCount("cache.hits"), 1);
+    EXPECT_EQ(sc::Statistics::Get().GetCount("cache.misses"), 1);
+    EXPECT_EQ(sc::Statistics::Get().GetCount("cache.stores"), 1);
+    fs::remove_all(dir);
+}
+
+TEST(CacheTest, EvictLeastRecentlyUsed) {
+    auto dir = MakeCacheDir("sc_test_cache_evict");
+    sc::CompileCache cache(dir, "", 250);
+    std::string text(100, 'x');
+
+    cache.Store("a", text);
+    cache.Store("b", text);
+    fs::last_write_time(dir / "a", fs::file_time_type::clock::now() -
+                                       std::chrono::seconds(10));
+    fs::last_write_time(dir / "b", fs::file_time_type::clock::now() -
+                                       std::chrono::seconds(5));
+    cache.Store("c", text);
+
+    EXPECT_FALSE(fs::exists(dir / "a"));
+    EXPECT_TRUE(fs::exists(dir / "b"));
+    EXPECT_TRUE(fs::exists(dir / "c"));
+    fs::remove_all(dir);
+}
@@ -195,3 +195,41 @@ TEST(CFGTest, CFGGol) {
     BUILD_CFG()
     CHECK_CFG()
 }
+
+TEST(CFGTest, CloneBlocks) {
+    // clang-format off
+    std::vector<std::vector<std::vector<size_t>>> successors = {
+        {{1, 2}, {3}, {3}, {4}, {5, 7}, {6}, {4}, {}},
+        {{1}, {2, 7}, {3}, {4, 6}, {5}, {3}, {1}, {}},
+        {{1}, {2, 7}, {3}, {1}, {5, 7}, {6}, {4}, {}},
+        {{}}
+    };
+    std::vector<std::vector<std::vector<size_t>>> predecessors = {
+        {{}, {0}, {0}, {1, 2}, {3, 6}, {4}, {5}, {4}},
+        {{}, {0, 6}, {1}, {2, 5}, {3}, {4}, {3}, {1}},
+        {{}, {3, 0}, {1}, {2}, {6}, {4}, {5}, {4, 1}},
+        {{}}
+    };
+    std::vector<std::vector<size_t>> postorder = {
+        {6, 5, 7, 4, 3, 1, 2, 0},
+        {5, 4, 6, 3, 2, 7, 1, 0},
+        {3, 2, 7, 1, 0},
+        {0}
+    };
+    // clang-format on
+
+    READ_PROGRAM("../tests/bril/1dconv.json")
+    BUILD_CFG()
+
+    // Loop of printoutput, entered through the clones
+    auto *func = program->GetFunction(2);
+    std::vector<sc::Block *> loop = {func->GetBlock(1), func->GetBlock(2),
+                                     func->GetBlock(3)};
+    auto clones = sc::CloneBlocks(func, loop, "c_", 1);
+    sc::RedirectEdge(func->GetBlock(0), loop[0], clones[loop[0]]);
+
+    EXPECT_EQ(clones[loop[0]]->GetName(), "c_for.cond");
+    EXPECT_EQ(clones[loop[2]]->GetInstructionSize(),
+              loop[2]->GetInstructionSize());
+    CHECK_CFG()
+}
@@ -86,3 +86,47 @@ TEST(ParserTest, ParseGol) {
     READ_RESULT("../tests/bril/gol.bril")
     EXPECT_EQ(output.str(), testp.str());
 }
+
+TEST(ParserTest, StreamGol) {
+    std::ifstream ifs("../tests/bril/gol.json");
+    std::stringstream output;
+    size_t count = 0;
+    sc::BrilParser::StreamProgram(
+        ifs, [&output, &count](std::unique_ptr<sc::Function> func) {
+            func->Dump(output);
+            ++count;
+        });
+    EXPECT_EQ(count, 9);
+    READ_RESULT("../tests/bril/gol.bril")
+    EXPECT_EQ(output.str(), testp.str());
+}
+
+TEST(ParserTest, ParseManyFunctions) {
+    // Every function interns the same constants while they are parsed
+    // concurrently, the program must still be in source order.
+    std::stringstream json;
+    json << "{\"functions\": [";
+    for (int i = 0; i < 64; ++i) {
+        json << (i ? "," : "") << "{\"name\": \"f" << i << "\", \"instrs\": [";
+        for (int j = 0; j < 32; ++j) {
+            json << (j ? "," : "") << "{\"dest\": \"v" << j
+                 << "\", \"type\": \"int\", \"op\": \"const\", \"value\": "
+                 << j << "}";
+        }
+        json << "]}";
+    }
+    json << "]}";
+
+    auto program = sc::BrilParser::ParseProgram(json);
+    ASSERT_EQ(program->GetSize(), 64);
+    for (size_t i = 0; i < program->GetSize(); ++i) {
+        auto *func = program->GetFunction(i);
+        EXPECT_EQ(func->GetName(), "f" + std::to_string(i));
+        auto *block = func->GetBlock(0);
+        ASSERT_EQ(block->GetInstructionSize(), 32);
+        for (size_t j = 0; j < block->GetInstructionSize(); ++j) {
+            EXPECT_EQ(block->GetInstruction(j)->GetOperand(0),
+                      sc::IntOperand::GetOperand(static_cast<int64_t>(j)));
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include "ir_serializer.hpp"
+#include "test_utils.hpp"
+#include "transformers/cf_transformer.hpp"
+#include "transformers/dvn_transformer.hpp"
+#include "transformers/ssa_transformer.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+#define DUMP_ALL(program, output)                                              \
+    for (auto &f : *program) {                                                 \
+        f->Dump(output);                                                       \
+        f->DumpCFG(output);                                                    \
+        f->DumpDefUseLinks(output);                                            \
+    }
+
+#define ROUND_TRIP(stage)                                                      \
+    std::stringstream snapshot;                                                \
+    sc::WriteIR(program.get(), snapshot, stage);                               \
+    auto data = snapshot.str();                                                \
+    std::string loaded_stage;                                                  \
+    auto loaded = sc::LoadIR(data.data(), data.size(), &loaded_stage);         \
+    EXPECT_EQ(loaded_stage, stage);                                            \
+    std::stringstream expected, output;                                        \
+    DUMP_ALL(program, expected);                                               \
+    DUMP_ALL(loaded, output);                                                  \
+    EXPECT_EQ(output.str(), expected.str());
+
+TEST(SerializerTest, RoundTripCFG) {
+    READ_PROGRAM("../tests/bril/gol.json");
+    BUILD_CFG();
+    ROUND_TRIP("cfg");
+}
+
+TEST(SerializerTest, RoundTripSSA) {
+    READ_PROGRAM("../tests/bril/gol.json");
+    BUILD_CFG();
+    program = sc::ApplyTransformation<sc::CFTransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::SSATransformer>(std::move(program));
+    program = sc::ApplyTransformation<sc::DVNTransformer>(std::move(program));
+    ROUND_TRIP("dvn");
+
+    // The loaded program must be usable by later passes
+    loaded = sc::ApplyTransformation<sc::DVNTransformer>(std::move(loaded));
+    program = sc::ApplyTransformation<sc::DVNTransformer>(std::move(program));
+    std::stringstream a, b;
+    program->Dump(a);
+    loaded->Dump(b);
+    EXPECT_EQ(b.str(), a.str());
+}
+
+TEST(SerializerTest, RejectTruncated) {
+    READ_PROGRAM("../tests/bril/gol.json");
+    std::stringstream snapshot;
+    sc::WriteIR(program.get(), snapshot, "parse");
+    auto data = snapshot.str();
+    EXPECT_THROW(sc::LoadIR(data.data(), data.size() / 2), std::runtime_error);
+    EXPECT_THROW(sc::LoadIR(data.data() + 1, data.size() - 1),
+                 std::runtime_error);
+}
@@ -0,0 +1,151 @@
+#include "compile_server.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void SendRequest(int fd, const std::string &text) {
+    auto size = static_cast<uint32_t>(text.size());
+    ASSERT_EQ(write(fd, &size, sizeof(size)), sizeof(size));
+    ASSERT_EQ(write(fd, text.data(), text.size()),
+              static_cast<ssize_t>(text.size()));
+}
+
+static std::pair<uint8_t, std::string> ReadReply(int fd) {
+    uint8_t status;
+    uint32_t size;
+    EXPECT_EQ(read(fd, &status, 1), 1);
+    EXPECT_EQ(read(fd, &size, sizeof(size)), sizeof(size));
+    std::string text(size, '\0');
+    size_t n = 0;
+    while (n < size) {
+        n += static_cast<size_t>(read(fd, text.data() + n, size - n));
+    }
+    return {status, text};
+}
+
+static std::string Echo(std::istream &input) {
+    std::string text;
+    std::getline(input, text);
+    if (text == "fail") {
+        throw std::runtime_error("Error compiling.\n");
+    }
+    return text + "!";
+}
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+    std::atomic<int> count = 0;
+    std::vector<std::future<int>> results;
+    {
+        sc::ThreadPool pool(4);
+        for (int i = 0; i < 100; ++i) {
+            results.push_back(pool.Submit([i, &count] {
+                ++count;
+                return i * i;
+            }));
+        }
+    }
+    EXPECT_EQ(count, 100);
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(results[static_cast<size_t>(i)].get(), i * i);
+    }
+}
+
+TEST(ServerTest, ServeStreamInOrder) {
+    int request[2], reply[2];
+    ASSERT_EQ(pipe(request), 0);
+    ASSERT_EQ(pipe(reply), 0);
+
+    sc::CompileServer server(Echo, 4);
+    std::thread thread([&] { server.Serve(request[0], reply[1]); });
+
+    for (int i = 0; i < 16; ++i) {
+        SendRequest(request[1], i == 7 ? "fail" : std::to_string(i));
+    }
+    close(request[1]);
+
+    for (int i = 0; i < 16; ++i) {
+        auto [status, text] = ReadReply(reply[0]);
+        if (i == 7) {
+            EXPECT_EQ(status, 1);
+            EXPECT_EQ(text, "Error compiling.\n");
+        } else {
+            EXPECT_EQ(status, 0);
+            EXPECT_EQ(text, std::to_string(i) + "!");
+        }
+    }
+
+    thread.join();
+    close(request[0]);
+    close(reply[0]);
+    close(reply[1]);
+}
+
+TEST(ServerTest, OversizedFrame) {
+    int request[2], reply[2];
+    ASSERT_EQ(pipe(request), 0);
+    ASSERT_EQ(pipe(reply), 0);
+
+    // The stream ends at a frame too large to allocate, without a reply
+    sc::CompileServer server(Echo, 1);
+    uint32_t size = 0xffffffff;
+    ASSERT_EQ(write(request[1], &size, sizeof(size)), sizeof(size));
+    server.Serve(request[0], reply[1]);
+    close(reply[1]);
+
+    char c;
+    EXPECT_EQ(read(reply[0], &c, 1), 0);
+    close(request[0]);
+    close(request[1]);
+    close(reply[0]);
+}
+
+TEST(ServerTest, IdleConnection) {
+    auto path = std::filesystem::temp_directory_path() / "sc_test_idle";
+    std::filesystem::remove(path);
+    // Served by a child, the threads of the server would outlive the test
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (!pid) {
+        sc::CompileServer server(Echo, 1);
+        server.Serve(path);
+        _exit(0);
+    }
+
+    std::stringstream out, err;
+    int status = 1;
+    while (!sc::RunClient(path, "wait", out, err, status)) {
+        std::this_thread::yield();
+    }
+
+    // An open connection doesn't hold the only worker
+    auto idle = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    ASSERT_EQ(connect(idle, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+              0);
+    out.str("");
+    EXPECT_TRUE(sc::RunClient(path, "next", out, err, status));
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(out.str(), "next!");
+    close(idle);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+TEST(ServerTest, ClientWithoutServer) {
+    auto path = std::filesystem::temp_directory_path() / "sc_test_no_server";
+    std::filesystem::remove(path);
+    std::stringstream out, err;
+    int status = 0;
+    EXPECT_FALSE(sc::RunClient(path, "{}", out, err, status));
+}